@@ -74,6 +74,11 @@ typedef enum evi_encode_type {
     EVI_ENCODE_TYPE_QUERY = 1
 } evi_encode_type_t;
 
+typedef enum evi_half_format {
+    EVI_HALF_FORMAT_FP16 = 0,
+    EVI_HALF_FORMAT_BF16 = 1
+} evi_half_format_t;
+
 typedef enum evi_seal_mode {
     EVI_SEAL_MODE_HSM_PORT = 0,
     EVI_SEAL_MODE_HSM_SERIAL = 1,
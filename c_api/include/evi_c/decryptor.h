@@ -32,6 +32,14 @@ evi_status_t evi_decryptor_decrypt_search_result_with_seckey(evi_decryptor_t *de
                                                              const evi_secret_key_t *seckey, int is_score,
                                                              const double *scale, evi_message_t **out_message);
 
+evi_status_t evi_decryptor_get_search_result_size(const evi_decryptor_t *decryptor, const evi_search_result_t *result,
+                                                  size_t *out_length);
+
+evi_status_t evi_decryptor_decrypt_search_result_into(evi_decryptor_t *decryptor, const evi_search_result_t *result,
+                                                      const evi_secret_key_t *seckey, int is_score,
+                                                      const double *scale, float *out, size_t capacity,
+                                                      size_t *out_length);
+
 evi_status_t evi_decryptor_decrypt_search_result_with_path(evi_decryptor_t *decryptor,
                                                            const evi_search_result_t *result, const char *key_path,
                                                            int is_score, const double *scale,
@@ -35,6 +35,16 @@ evi_status_t evi_encryptor_encode_vector(const evi_encryptor_t *encryptor, const
                                          evi_encode_type_t encode_type, int level, const float *scale,
                                          evi_query_t **out_query);
 
+// input : 1 fp16/bf16 data, output : 1 query
+evi_status_t evi_encryptor_encode_vector_half(const evi_encryptor_t *encryptor, const uint16_t *data, size_t dim,
+                                              evi_half_format_t format, evi_encode_type_t encode_type, int level,
+                                              const float *scale, evi_query_t **out_query);
+
+// input : 1 int8 data with its dequantization scale, output : 1 query
+evi_status_t evi_encryptor_encode_vector_int8(const evi_encryptor_t *encryptor, const int8_t *data, size_t dim,
+                                              float quant_scale, evi_encode_type_t encode_type, int level,
+                                              const float *scale, evi_query_t **out_query);
+
 // input : batch data, output : batch queries
 evi_status_t evi_encryptor_encode_batch(const evi_encryptor_t *encryptor, const float *const *data, const size_t dim,
                                         size_t data_count, evi_encode_type_t encode_type, int level, const float *scale,
@@ -56,6 +66,18 @@ evi_status_t evi_encryptor_encrypt_vector_with_pack(const evi_encryptor_t *encry
                                                     const float *data, size_t dim, evi_encode_type_t encode_type,
                                                     int level, const float *scale, evi_query_t **out_query);
 
+// input : 1 fp16/bf16 data, output : 1 query
+evi_status_t evi_encryptor_encrypt_vector_half_with_pack(const evi_encryptor_t *encryptor, const evi_keypack_t *pack,
+                                                         const uint16_t *data, size_t dim, evi_half_format_t format,
+                                                         evi_encode_type_t encode_type, int level, const float *scale,
+                                                         evi_query_t **out_query);
+
+// input : 1 int8 data with its dequantization scale, output : 1 query
+evi_status_t evi_encryptor_encrypt_vector_int8_with_pack(const evi_encryptor_t *encryptor, const evi_keypack_t *pack,
+                                                         const int8_t *data, size_t dim, float quant_scale,
+                                                         evi_encode_type_t encode_type, int level, const float *scale,
+                                                         evi_query_t **out_query);
+
 // input : batch data, output : batch query
 evi_status_t evi_encryptor_encrypt_batch_with_path(const evi_encryptor_t *encryptor, const char *enckey_path,
                                                    const float *const *data, const size_t dim, size_t data_count,
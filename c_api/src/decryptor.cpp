@@ -53,6 +53,29 @@ evi_status_t evi_decryptor_decrypt_search_result_with_seckey(evi_decryptor_t *de
     });
 }
 
+evi_status_t evi_decryptor_get_search_result_size(const evi_decryptor_t *decryptor, const evi_search_result_t *result,
+                                                  size_t *out_length) {
+    if (!decryptor || !result || !out_length) {
+        return set_error(EVI_STATUS_INVALID_ARGUMENT, "null argument");
+    }
+    return invoke_and_catch([&]() {
+        *out_length = decryptor->impl.getDecryptSize(result->impl);
+    });
+}
+
+evi_status_t evi_decryptor_decrypt_search_result_into(evi_decryptor_t *decryptor, const evi_search_result_t *result,
+                                                      const evi_secret_key_t *seckey, int is_score,
+                                                      const double *scale, float *out, size_t capacity,
+                                                      size_t *out_length) {
+    if (!decryptor || !result || !seckey || !out || !out_length) {
+        return set_error(EVI_STATUS_INVALID_ARGUMENT, "null argument");
+    }
+    return invoke_and_catch([&]() {
+        *out_length =
+            decryptor->impl.decryptTo(result->impl, seckey->impl, is_score != 0, out, capacity, to_optional(scale));
+    });
+}
+
 evi_status_t evi_decryptor_decrypt_search_result_with_path(evi_decryptor_t *decryptor,
                                                            const evi_search_result_t *result, const char *key_path,
                                                            int is_score, const double *scale,
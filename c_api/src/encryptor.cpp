@@ -27,6 +27,23 @@
 
 using namespace evi::c_api::detail;
 
+namespace {
+
+evi_status_t translate_half_format(evi_half_format_t format, evi::HalfFormat &out_format) {
+    switch (format) {
+    case EVI_HALF_FORMAT_FP16:
+        out_format = evi::HalfFormat::FP16;
+        return EVI_STATUS_SUCCESS;
+    case EVI_HALF_FORMAT_BF16:
+        out_format = evi::HalfFormat::BF16;
+        return EVI_STATUS_SUCCESS;
+    default:
+        return set_error(EVI_STATUS_INVALID_ARGUMENT, "unknown half format");
+    }
+}
+
+} // namespace
+
 extern "C" {
 
 evi_status_t evi_encryptor_create(const evi_context_t *context, evi_encryptor_t **out_encryptor) {
@@ -74,6 +91,40 @@ evi_status_t evi_encryptor_encode_vector(const evi_encryptor_t *encryptor, const
     });
 }
 
+evi_status_t evi_encryptor_encode_vector_half(const evi_encryptor_t *encryptor, const uint16_t *data, size_t length,
+                                              evi_half_format_t format, evi_encode_type_t encode_type, int level,
+                                              const float *scale, evi_query_t **out_query) {
+    if (!encryptor || !data || !out_query) {
+        return set_error(EVI_STATUS_INVALID_ARGUMENT, "null argument");
+    }
+
+    evi::HalfFormat cpp_format{};
+    evi_status_t status = translate_half_format(format, cpp_format);
+    if (status != EVI_STATUS_SUCCESS) {
+        return status;
+    }
+
+    return invoke_and_catch([&]() {
+        evi::Query q = encryptor->impl.encode(data, length, cpp_format, static_cast<evi::EncodeType>(encode_type),
+                                              level, to_optional(scale));
+        *out_query = new evi_query(std::move(q));
+    });
+}
+
+evi_status_t evi_encryptor_encode_vector_int8(const evi_encryptor_t *encryptor, const int8_t *data, size_t length,
+                                              float quant_scale, evi_encode_type_t encode_type, int level,
+                                              const float *scale, evi_query_t **out_query) {
+    if (!encryptor || !data || !out_query) {
+        return set_error(EVI_STATUS_INVALID_ARGUMENT, "null argument");
+    }
+
+    return invoke_and_catch([&]() {
+        evi::Query q = encryptor->impl.encode(data, length, quant_scale, static_cast<evi::EncodeType>(encode_type),
+                                              level, to_optional(scale));
+        *out_query = new evi_query(std::move(q));
+    });
+}
+
 evi_status_t evi_encryptor_encode_batch(const evi_encryptor_t *encryptor, const float *const *data, const size_t dim,
                                         size_t data_count, evi_encode_type_t encode_type, int level, const float *scale,
                                         evi_query_t ***out_queries, size_t *out_count) {
@@ -177,6 +228,42 @@ evi_status_t evi_encryptor_encrypt_vector_with_pack(const evi_encryptor_t *encry
     });
 }
 
+evi_status_t evi_encryptor_encrypt_vector_half_with_pack(const evi_encryptor_t *encryptor, const evi_keypack_t *pack,
+                                                         const uint16_t *data, size_t length, evi_half_format_t format,
+                                                         evi_encode_type_t encode_type, int level, const float *scale,
+                                                         evi_query_t **out_query) {
+    if (!encryptor || !pack || !data || !out_query) {
+        return set_error(EVI_STATUS_INVALID_ARGUMENT, "null argument");
+    }
+
+    evi::HalfFormat cpp_format{};
+    evi_status_t status = translate_half_format(format, cpp_format);
+    if (status != EVI_STATUS_SUCCESS) {
+        return status;
+    }
+
+    return invoke_and_catch([&]() {
+        evi::Query q = encryptor->impl.encrypt(data, length, cpp_format, pack->impl,
+                                               static_cast<evi::EncodeType>(encode_type), level, to_optional(scale));
+        *out_query = new evi_query(std::move(q));
+    });
+}
+
+evi_status_t evi_encryptor_encrypt_vector_int8_with_pack(const evi_encryptor_t *encryptor, const evi_keypack_t *pack,
+                                                         const int8_t *data, size_t length, float quant_scale,
+                                                         evi_encode_type_t encode_type, int level, const float *scale,
+                                                         evi_query_t **out_query) {
+    if (!encryptor || !pack || !data || !out_query) {
+        return set_error(EVI_STATUS_INVALID_ARGUMENT, "null argument");
+    }
+
+    return invoke_and_catch([&]() {
+        evi::Query q = encryptor->impl.encrypt(data, length, quant_scale, pack->impl,
+                                               static_cast<evi::EncodeType>(encode_type), level, to_optional(scale));
+        *out_query = new evi_query(std::move(q));
+    });
+}
+
 evi_status_t evi_encryptor_encrypt_batch_with_path(const evi_encryptor_t *encryptor, const char *enckey_path,
                                                    const float *const *data, const size_t dim, size_t data_count,
                                                    evi_encode_type_t encode_type, int level, const float *scale,
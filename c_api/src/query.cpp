@@ -24,7 +24,6 @@
 #include <cstdlib>
 #include <fstream>
 #include <new>
-#include <sstream>
 #include <string>
 #include <vector>
 
@@ -139,18 +138,22 @@ evi_status_t evi_query_serialize_to_string(const evi_query_t *query, char **out_
         return set_error(EVI_STATUS_INVALID_ARGUMENT, "null argument");
     }
     return invoke_and_catch([&]() {
-        std::string data;
-        evi::Query::serializeToString(query->impl, data);
-        *out_size = data.size();
-        if (*out_size == 0) {
+        const size_t size = evi::Query::getSerializedSize(query->impl);
+        *out_size = size;
+        if (size == 0) {
             *out_data = nullptr;
             return;
         }
-        auto *buffer = static_cast<char *>(std::malloc(*out_size));
+        auto *buffer = static_cast<char *>(std::malloc(size));
         if (!buffer) {
             throw std::bad_alloc();
         }
-        std::memcpy(buffer, data.data(), *out_size);
+        try {
+            evi::Query::serializeToBuffer(query->impl, buffer, size);
+        } catch (...) {
+            std::free(buffer);
+            throw;
+        }
         *out_data = buffer;
     });
 }
@@ -160,8 +163,7 @@ evi_status_t evi_query_deserialize_from_string(const char *data, size_t size, ev
         return set_error(EVI_STATUS_INVALID_ARGUMENT, "null argument");
     }
     return invoke_and_catch([&]() {
-        std::string str(data, size);
-        evi::Query q = evi::Query::deserializeFromString(str);
+        evi::Query q = evi::Query::deserializeFromBuffer(data, size);
         *out_query = new evi_query(std::move(q));
     });
 }
@@ -312,8 +314,7 @@ evi_status_t evi_query_vector_deserialize_from_string(const char *data, size_t s
         return set_error(EVI_STATUS_INVALID_ARGUMENT, "null argument");
     }
     return invoke_and_catch([&]() {
-        std::string str(data, size);
-        std::vector<evi::Query> vec = evi::Query::deserializeVectorFromString(str);
+        std::vector<evi::Query> vec = evi::Query::deserializeVectorFromBuffer(data, size);
         if (vec.empty()) {
             *out_queries = nullptr;
             *out_count = 0;
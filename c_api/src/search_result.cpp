@@ -22,10 +22,8 @@
 #include "evi_c/internal/stream_utils.hpp"
 
 #include <cstdlib>
-#include <cstring>
 #include <fstream>
 #include <new>
-#include <sstream>
 #include <string>
 
 using namespace evi::c_api::detail;
@@ -107,19 +105,22 @@ evi_status_t evi_search_result_serialize_to_string(const evi_search_result_t *re
         return set_error(EVI_STATUS_INVALID_ARGUMENT, "null argument");
     }
     return invoke_and_catch([&]() {
-        std::ostringstream out(std::ios::binary);
-        evi::SearchResult::serializeTo(result->impl, out);
-        std::string data = out.str();
-        *out_size = data.size();
-        if (*out_size == 0) {
+        const size_t size = evi::SearchResult::getSerializedSize(result->impl);
+        *out_size = size;
+        if (size == 0) {
             *out_data = nullptr;
             return;
         }
-        auto *buffer = static_cast<char *>(std::malloc(*out_size));
+        auto *buffer = static_cast<char *>(std::malloc(size));
         if (!buffer) {
             throw std::bad_alloc();
         }
-        std::memcpy(buffer, data.data(), *out_size);
+        try {
+            evi::SearchResult::serializeToBuffer(result->impl, buffer, size);
+        } catch (...) {
+            std::free(buffer);
+            throw;
+        }
         *out_data = buffer;
     });
 }
@@ -130,10 +131,7 @@ evi_status_t evi_search_result_deserialize_from_string(const char *data, size_t
         return set_error(EVI_STATUS_INVALID_ARGUMENT, "null argument");
     }
     return invoke_and_catch([&]() {
-        std::string buffer(data, size);
-        std::istringstream in(buffer, std::ios::binary);
-        in.exceptions(std::ios::badbit);
-        evi::SearchResult res = evi::SearchResult::deserializeFrom(in);
+        evi::SearchResult res = evi::SearchResult::deserializeFromBuffer(data, size);
         *out_result = new evi_search_result(std::move(res));
     });
 }
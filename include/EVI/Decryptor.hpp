@@ -24,8 +24,13 @@
 #include "EVI/Query.hpp"
 #include "EVI/SearchResult.hpp"
 #include "EVI/SecretKey.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <istream>
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace evi {
 
@@ -71,6 +76,40 @@ public:
     Message decrypt(const SearchResult &item, const SecretKey &seckey, bool is_score,
                     std::optional<double> scale = std::nullopt);
 
+    /**
+     * @brief Decrypts several search results in one call.
+     *
+     * The ciphertexts of all results are decrypted together across the decryptor's threads, so many small
+     * results cost about as much as one large result.
+     * @param items Encrypted search results.
+     * @param seckey Secret key used for decryption.
+     * @param is_score Indicates whether the decrypted results should be interpreted as scores.
+     * @param scale Optional scaling factor for precise score computation.
+     * @return One decrypted `Message` per item, in the same order.
+     */
+    std::vector<Message> decrypt(const std::vector<SearchResult> &items, const SecretKey &seckey, bool is_score,
+                                 std::optional<double> scale = std::nullopt);
+
+    /**
+     * @brief Returns the number of floats a search result decrypts to.
+     * @param item Encrypted search result.
+     * @return Capacity `decryptTo()` needs for `item`.
+     */
+    size_t getDecryptSize(const SearchResult &item) const;
+
+    /**
+     * @brief Decrypts a search result straight into a caller-provided buffer, without an intermediate `Message`.
+     * @param item Encrypted search result.
+     * @param seckey Secret key used for decryption.
+     * @param is_score Indicates whether the decrypted result should be interpreted as a score.
+     * @param out Destination buffer.
+     * @param capacity Number of floats available at `out`; must be at least `getDecryptSize(item)`.
+     * @param scale Optional scaling factor for precise score computation.
+     * @return Number of floats written to `out`.
+     */
+    size_t decryptTo(const SearchResult &item, const SecretKey &seckey, bool is_score, float *out, size_t capacity,
+                     std::optional<double> scale = std::nullopt);
+
     /**
      * @brief Decrypts a search result using a key loaded from a file.
      * @param item Encrypted search result.
@@ -116,20 +155,147 @@ public:
      * @param ctxt Encrypted query to decrypt.
      * @param seckey Secret key used for decryption.
      * @param scale Optional scaling factor to adjust precision.
-     * @return Decrypted `Message`.
+     * @return Decrypted `Message`. For a packed FLAT query, its items are returned back to back.
      */
     Message decrypt(const Query &ctxt, const SecretKey &seckey, std::optional<double> scale = std::nullopt);
 
     /**
      * @brief Decrypts a specific item from an encrypted query. This function is only supported in RMP mode.
-     * @param idx Index of the item to decrypt.
+     * @param idx Index of the item to decrypt. A query encrypted as `EncodeType::QUERY` only holds item 0.
      * @param ctxt Encrypted query.
      * @param key Secret key used for decryption.
      * @param scale Optional scaling factor to adjust precision.
      * @return Decrypted `Message`.
+     * @throws InvalidInputError if `idx` is not an item of `ctxt`.
      */
     Message decrypt(int idx, const Query &ctxt, const SecretKey &seckey, std::optional<double> scale = std::nullopt);
 
+    /**
+     * @brief Decrypts every item of an encrypted query at once. This function is only supported in RMP mode.
+     *
+     * Each ciphertext of the query is decrypted a single time, so reading all items this way is cheaper than
+     * calling `decrypt(idx, ...)` once per item.
+     * @param ctxt Encrypted query.
+     * @param seckey Secret key used for decryption.
+     * @param scale Optional scaling factor to adjust precision.
+     * @return One decrypted `Message` per item, in index order.
+     */
+    std::vector<Message> decryptItems(const Query &ctxt, const SecretKey &seckey,
+                                      std::optional<double> scale = std::nullopt);
+
+    /**
+     * @brief Decrypts the selected items of an encrypted query. This function is only supported in RMP mode.
+     *
+     * Each ciphertext of the query is still decrypted a single time; only the coefficients of the selected items are
+     * read out of it.
+     * @param ctxt Encrypted query.
+     * @param seckey Secret key used for decryption.
+     * @param indices Indices of the items to decrypt; they may repeat and need not be sorted.
+     * @param scale Optional scaling factor to adjust precision.
+     * @return One decrypted `Message` per entry of `indices`, in the same order.
+     * @throws InvalidInputError if an index is not an item of `ctxt`.
+     */
+    std::vector<Message> decryptItems(const Query &ctxt, const SecretKey &seckey, const std::vector<uint64_t> &indices,
+                                      std::optional<double> scale = std::nullopt);
+
+    /**
+     * @brief Decrypts a search result and returns only its `k` highest scores.
+     *
+     * Each worker keeps a bounded heap while decoding its ciphertexts, so the dense score vector is never built.
+     * Not supported in `EvalMode::MM`.
+     * @param item Encrypted search result.
+     * @param seckey Secret key used for decryption.
+     * @param k Number of scores to return.
+     * @param scale Optional scaling factor for precise score computation.
+     * @return Up to `k` (item index, score) pairs, highest score first; equal scores keep the lower index first.
+     * Every decoded score is a candidate; use `decryptAboveTopK()` to exclude scores at or below a threshold.
+     */
+    std::vector<std::pair<uint64_t, float>> decryptTopK(const SearchResult &item, const SecretKey &seckey, uint32_t k,
+                                                        std::optional<double> scale = std::nullopt);
+
+    /**
+     * @brief Decrypts the scores of every shard of a sharded search result.
+     *
+     * The ciphertexts of all shards are decrypted in parallel, and each score is written to its global item index.
+     * @param item Encrypted sharded search result.
+     * @param seckey Secret key used for decryption.
+     * @param scale Optional scaling factor for precise score computation.
+     * @return Scores indexed by global item index, one per item of all shards.
+     * @throws InvalidInputError if the shards' item ranges overlap or do not cover the items contiguously from 0.
+     */
+    Message decrypt(const ShardedSearchResult &item, const SecretKey &seckey,
+                    std::optional<double> scale = std::nullopt);
+
+    /**
+     * @brief Decrypts a sharded search result and returns the k highest scores over all shards.
+     * @param item Encrypted sharded search result.
+     * @param seckey Secret key used for decryption.
+     * @param k Maximum number of entries to return.
+     * @param scale Optional scaling factor for precise score computation.
+     * @return Up to `k` (global item index, score) pairs, ordered as by `decryptTopK()` on a single result.
+     */
+    std::vector<std::pair<uint64_t, float>> decryptTopK(const ShardedSearchResult &item, const SecretKey &seckey,
+                                                        uint32_t k, std::optional<double> scale = std::nullopt);
+
+    /**
+     * @brief Decrypts a search result and returns only the scores above a threshold.
+     * @param item Encrypted search result.
+     * @param seckey Secret key used for decryption.
+     * @param threshold Scores must be strictly greater than this value to be returned.
+     * @param scale Optional scaling factor for precise score computation.
+     * @return Every qualifying (item index, score) pair, in item index order.
+     */
+    std::vector<std::pair<uint64_t, float>> decryptAbove(const SearchResult &item, const SecretKey &seckey,
+                                                         float threshold, std::optional<double> scale = std::nullopt);
+
+    /**
+     * @brief Decrypts a search result and returns at most `max_count` of the scores above a threshold.
+     * @param item Encrypted search result.
+     * @param seckey Secret key used for decryption.
+     * @param threshold Scores must be strictly greater than this value to be returned.
+     * @param max_count Maximum number of pairs to return.
+     * @param scale Optional scaling factor for precise score computation.
+     * @return The best qualifying (item index, score) pairs, ordered as by `decryptTopK()`.
+     */
+    std::vector<std::pair<uint64_t, float>> decryptAboveTopK(const SearchResult &item, const SecretKey &seckey,
+                                                             float threshold, uint32_t max_count,
+                                                             std::optional<double> scale = std::nullopt);
+
+    /**
+     * @brief Decrypts a search result chunk by chunk while it is read from a stream.
+     *
+     * The stream may hold a result written by `SearchResult::serializeChunkedTo()` or by `SearchResult::serializeTo()`.
+     * Each chunk is decrypted as soon as it has been read, while the next one is being read, so only two chunks are
+     * kept in memory. The `serializeTo()` layout stores each polynomial of all ciphertexts together, so it is read
+     * in chunks of 16 ciphertexts by seeking; if the stream is not seekable, it is read and decrypted whole first.
+     * @param is Input stream positioned at the serialized search result.
+     * @param seckey Secret key used for decryption.
+     * @param is_score Indicates whether the decrypted result should be interpreted as a score.
+     * @param on_chunk Called once per chunk, in order, with the index of its first item and its values. The
+     *        values are only valid during the call.
+     * @param scale Optional scaling factor for precise score computation.
+     */
+    void decryptStream(std::istream &is, const SecretKey &seckey, bool is_score,
+                       const std::function<void(uint64_t offset, const float *values, size_t count)> &on_chunk,
+                       std::optional<double> scale = std::nullopt);
+
+    /**
+     * @brief Keeps secret keys loaded by the `key_path` and `key_stream` overloads unpacked between calls.
+     *
+     * Keys are matched on their full serialized bytes, so a replaced key file is picked up on the next call.
+     * Evicted keys are zeroized. The cache is disabled by default.
+     * @param capacity Maximum number of cached keys; 0 disables the cache and wipes the keys it holds.
+     */
+    void setSecretKeyCacheCapacity(std::size_t capacity);
+
+    /**
+     * @brief Limits the threads used to decrypt the ciphertexts of one search result.
+     *
+     * Each result ciphertext is decrypted independently and written to its final offset in the output.
+     * @param num_threads Maximum number of threads; 0 (the default) uses the whole global pool, 1 runs sequentially.
+     */
+    void setNumThreads(uint32_t num_threads);
+
 private:
     std::shared_ptr<detail::Decryptor> impl_;
 };
@@ -31,6 +31,7 @@
 
 #include "EVI/Decryptor.hpp"
 #include "EVI/Encryptor.hpp"
+#include "EVI/ItemPacker.hpp"
 #include "EVI/KeyGenerator.hpp"
 #include "EVI/KeyPack.hpp"
 
@@ -23,7 +23,10 @@
 #include "EVI/Export.hpp"
 #include "EVI/KeyPack.hpp"
 #include "EVI/Query.hpp"
+#include "EVI/QueryCacheStats.hpp"
 
+#include <cstddef>
+#include <cstdint>
 #include <istream>
 #include <memory>
 #include <optional>
@@ -66,6 +69,56 @@ public:
     Query encode(const std::vector<float> &data, evi::EncodeType type, int level = 0,
                  std::optional<float> scale = std::nullopt) const;
 
+    /**
+     * @brief Encodes a 16-bit floating point vector without expanding the caller's data to fp32.
+     * @param data Input vector as raw fp16 or bf16 bit patterns.
+     * @param format Bit layout of the values in `data`.
+     * @param type Encoding type (`ITEM` or `QUERY`).
+     * @param level Optional remaining multiplicative depth (default: 0).
+     * @param scale Optional scaling factor for precision control.
+     * @return Encoded `Query` object.
+     */
+    Query encode(const std::vector<uint16_t> &data, HalfFormat format, evi::EncodeType type, int level = 0,
+                 std::optional<float> scale = std::nullopt) const;
+
+    /**
+     * @brief Encodes an int8-quantized vector; element `i` stands for `data[i] * quant_scale`.
+     * @param data Quantized input vector.
+     * @param quant_scale Dequantization scale of `data`.
+     * @param type Encoding type (`ITEM` or `QUERY`).
+     * @param level Optional remaining multiplicative depth (default: 0).
+     * @param scale Optional scaling factor for precision control.
+     * @return Encoded `Query` object.
+     */
+    Query encode(const std::vector<int8_t> &data, float quant_scale, evi::EncodeType type, int level = 0,
+                 std::optional<float> scale = std::nullopt) const;
+
+    /**
+     * @brief Encodes a 16-bit floating point vector read in place from caller memory.
+     * @param data Pointer to `length` raw fp16 or bf16 bit patterns.
+     * @param length Number of elements at `data`.
+     * @param format Bit layout of the values in `data`.
+     * @param type Encoding type (`ITEM` or `QUERY`).
+     * @param level Optional remaining multiplicative depth (default: 0).
+     * @param scale Optional scaling factor for precision control.
+     * @return Encoded `Query` object.
+     */
+    Query encode(const uint16_t *data, size_t length, HalfFormat format, evi::EncodeType type, int level = 0,
+                 std::optional<float> scale = std::nullopt) const;
+
+    /**
+     * @brief Encodes an int8-quantized vector read in place from caller memory.
+     * @param data Pointer to `length` quantized values; element `i` stands for `data[i] * quant_scale`.
+     * @param length Number of elements at `data`.
+     * @param quant_scale Dequantization scale of `data`.
+     * @param type Encoding type (`ITEM` or `QUERY`).
+     * @param level Optional remaining multiplicative depth (default: 0).
+     * @param scale Optional scaling factor for precision control.
+     * @return Encoded `Query` object.
+     */
+    Query encode(const int8_t *data, size_t length, float quant_scale, evi::EncodeType type, int level = 0,
+                 std::optional<float> scale = std::nullopt) const;
+
     /**
      * @brief Encodes a batch of plaintext vectors into individual `Query` objects.
      * @param data List of input vectors to encode.
@@ -123,6 +176,60 @@ public:
     Query encrypt(const std::vector<float> &data, const KeyPack &keypack, evi::EncodeType type, int level = 0,
                   std::optional<float> scale = std::nullopt) const;
 
+    /**
+     * @brief Encrypts a 16-bit floating point vector without expanding the caller's data to fp32.
+     * @param data Input vector as raw fp16 or bf16 bit patterns.
+     * @param format Bit layout of the values in `data`.
+     * @param keypack Key pack providing the encryption key.
+     * @param type Encoding type (`ITEM` or `QUERY`).
+     * @param level Optional remaining multiplicative depth (default: 0).
+     * @param scale Optional custom scale factor.
+     * @return Encrypted `Query` object.
+     */
+    Query encrypt(const std::vector<uint16_t> &data, HalfFormat format, const KeyPack &keypack, evi::EncodeType type,
+                  int level = 0, std::optional<float> scale = std::nullopt) const;
+
+    /**
+     * @brief Encrypts an int8-quantized vector; element `i` stands for `data[i] * quant_scale`.
+     * @param data Quantized input vector.
+     * @param quant_scale Dequantization scale of `data`.
+     * @param keypack Key pack providing the encryption key.
+     * @param type Encoding type (`ITEM` or `QUERY`).
+     * @param level Optional remaining multiplicative depth (default: 0).
+     * @param scale Optional custom scale factor.
+     * @return Encrypted `Query` object.
+     */
+    Query encrypt(const std::vector<int8_t> &data, float quant_scale, const KeyPack &keypack, evi::EncodeType type,
+                  int level = 0, std::optional<float> scale = std::nullopt) const;
+
+    /**
+     * @brief Encrypts a 16-bit floating point vector read in place from caller memory.
+     * @param data Pointer to `length` raw fp16 or bf16 bit patterns.
+     * @param length Number of elements at `data`.
+     * @param format Bit layout of the values in `data`.
+     * @param keypack Key pack providing the encryption key.
+     * @param type Encoding type (`ITEM` or `QUERY`).
+     * @param level Optional remaining multiplicative depth (default: 0).
+     * @param scale Optional custom scale factor.
+     * @return Encrypted `Query` object.
+     */
+    Query encrypt(const uint16_t *data, size_t length, HalfFormat format, const KeyPack &keypack,
+                  evi::EncodeType type, int level = 0, std::optional<float> scale = std::nullopt) const;
+
+    /**
+     * @brief Encrypts an int8-quantized vector read in place from caller memory.
+     * @param data Pointer to `length` quantized values; element `i` stands for `data[i] * quant_scale`.
+     * @param length Number of elements at `data`.
+     * @param quant_scale Dequantization scale of `data`.
+     * @param keypack Key pack providing the encryption key.
+     * @param type Encoding type (`ITEM` or `QUERY`).
+     * @param level Optional remaining multiplicative depth (default: 0).
+     * @param scale Optional custom scale factor.
+     * @return Encrypted `Query` object.
+     */
+    Query encrypt(const int8_t *data, size_t length, float quant_scale, const KeyPack &keypack, evi::EncodeType type,
+                  int level = 0, std::optional<float> scale = std::nullopt) const;
+
     /**
      * @brief Encrypts a batch of vectors into `Query` objects.
      * @param data List of input vectors to encrypt.
@@ -157,6 +264,72 @@ public:
     std::vector<Query> encrypt(const std::vector<std::vector<float>> &data, const KeyPack &keypack,
                                evi::EncodeType type, int level, std::optional<float> scale = std::nullopt) const;
 
+    /**
+     * @brief Encodes a vector scaled to unit L2 norm, without a separate normalization pass over the input.
+     * @param data Input vector to normalize and encode; a zero vector is encoded as is.
+     * @param type Encoding type (`ITEM` or `QUERY`).
+     * @param level Optional remaining multiplicative depth (default: 0).
+     * @param scale Optional scaling factor for precision control.
+     * @param norm Optional output receiving the L2 norm of `data`.
+     * @return Encoded `Query` object.
+     */
+    Query encodeNormalized(const std::vector<float> &data, evi::EncodeType type, int level = 0,
+                           std::optional<float> scale = std::nullopt, float *norm = nullptr) const;
+
+    /**
+     * @brief Encrypts a vector scaled to unit L2 norm, without a separate normalization pass over the input.
+     * @param data Input vector to normalize and encrypt; a zero vector is encrypted as is.
+     * @param keypack Key pack providing the encryption key.
+     * @param type Encoding type (`ITEM` or `QUERY`).
+     * @param level Optional remaining multiplicative depth (default: 0).
+     * @param scale Optional custom scale factor.
+     * @param norm Optional output receiving the L2 norm of `data`.
+     * @return Encrypted `Query` object.
+     */
+    Query encryptNormalized(const std::vector<float> &data, const KeyPack &keypack, evi::EncodeType type,
+                            int level = 0, std::optional<float> scale = std::nullopt, float *norm = nullptr) const;
+
+    /**
+     * @brief Encrypts a batch of vectors, each scaled to unit L2 norm.
+     * @param data List of input vectors to normalize and encrypt.
+     * @param keypack Key pack providing the encryption key.
+     * @param type Encoding type (`ITEM` or `QUERY`).
+     * @param level Optional remaining multiplicative depth (default: 0).
+     * @param scale Optional custom scale factor.
+     * @param norms Optional output receiving the L2 norm of every input vector.
+     * @return List of encrypted `Query` objects.
+     */
+    std::vector<Query> encryptNormalized(const std::vector<std::vector<float>> &data, const KeyPack &keypack,
+                                         evi::EncodeType type, int level = 0,
+                                         std::optional<float> scale = std::nullopt,
+                                         std::vector<float> *norms = nullptr) const;
+
+    /**
+     * @brief Enables a bounded LRU cache for single-vector `encode()` calls.
+     *
+     * Repeated inputs with the same encode parameters return the previously encoded `Query`, sharing its data.
+     * Cached queries must not be modified by the caller.
+     * @param capacity Maximum number of cached queries; 0 disables the cache and releases its memory.
+     */
+    void setQueryCacheCapacity(std::size_t capacity);
+
+    /**
+     * @brief Returns hit/miss statistics of the encoded-query cache.
+     * @return Current cache counters; all zero when the cache is disabled.
+     */
+    QueryCacheStats getQueryCacheStats() const;
+
+    /**
+     * @brief Packs several vectors into each ciphertext in `EvalMode::FLAT` batch encryption.
+     *
+     * When enabled, batch `encrypt()` places `DEGREE / nextPowerOfTwo(dim)` vectors per ciphertext, so each returned
+     * `Query` carries up to that many items (see `Query::getInnerItemCount()`). All vectors must share one dimension.
+     * Decrypting such a `Query` returns its items back to back, `dim` values each.
+     * @param enable True to pack, false to encrypt one vector per ciphertext (default).
+     * @throws evi::NotSupportedError if the encryptor is not in `EvalMode::FLAT`.
+     */
+    void setFlatItemPacking(bool enable);
+
     [[deprecated(
         "encrypt(data, type, level) will be removed soon; migrate to encrypt(data, keypack, type, level, scale)")]]
     Query encrypt(const std::vector<float> &data, evi::EncodeType type, int level = 0) const;
@@ -170,6 +343,11 @@ public:
 
 private:
     std::shared_ptr<detail::Encryptor> impl_;
+
+    /// @cond INTERNAL
+    friend std::shared_ptr<detail::Encryptor> &getImpl(Encryptor &) noexcept;
+    friend const std::shared_ptr<detail::Encryptor> &getImpl(const Encryptor &) noexcept;
+    /// @endcond
 };
 
 /**
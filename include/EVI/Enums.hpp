@@ -70,6 +70,8 @@ enum class EvalMode : uint8_t {
 enum class QueryType : uint8_t {
     SINGLE = 0,
     MATRIX = 1,
+    // A single-block query carrying several packed FLAT items; the item count follows the type byte.
+    PACKED_SINGLE = 2,
 };
 
 /**
@@ -82,6 +84,15 @@ enum class QueryType : uint8_t {
  */
 enum class DeviceType : uint8_t { CPU = 0, GPU = 1, AVX2 = 2 };
 
+/**
+ * @enum HalfFormat
+ * @brief Bit layout of 16-bit floating point input vectors
+ *
+ * - FP16: IEEE 754 binary16
+ * - BF16: bfloat16, the upper half of an IEEE 754 binary32
+ */
+enum class HalfFormat : uint8_t { FP16 = 0, BF16 = 1 };
+
 /**
  * @enum DataType
  * @brief Data type for index or query representation
@@ -0,0 +1,98 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (C) 2025, CryptoLab, Inc.                                       //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//     http://www.apache.org/licenses/LICENSE-2.0                             //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include "EVI/Encryptor.hpp"
+#include "EVI/Export.hpp"
+#include "EVI/KeyPack.hpp"
+#include "EVI/Query.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace evi {
+
+namespace detail {
+class ItemPacker;
+} // namespace detail
+
+/**
+ * @class ItemPacker
+ * @brief Packs RMP database items into ciphertexts across several calls.
+ *
+ * Batch `Encryptor::encrypt()` only fills ciphertexts within one call, so small batches leave many of them partly
+ * empty. An `ItemPacker` keeps the items that do not fill a ciphertext yet and encrypts them together with the items
+ * of later calls. Items are always encrypted as `EncodeType::ITEM`.
+ */
+class EVI_API ItemPacker {
+public:
+    /// @brief Empty handle; initialize with makeItemPacker() before use.
+    ItemPacker() : impl_(nullptr) {}
+
+    /**
+     * @brief Constructs an ItemPacker with an internal implementation.
+     * @param impl Shared pointer to the internal `detail::ItemPacker` object.
+     */
+    explicit ItemPacker(std::shared_ptr<detail::ItemPacker> impl) noexcept;
+
+    /**
+     * @brief Adds items and encrypts every ciphertext they complete.
+     * @param items Input vectors; all items added to one packer must share the same dimension.
+     * @return Queries for the completely filled ciphertexts, possibly empty.
+     */
+    std::vector<Query> add(const std::vector<std::vector<float>> &items);
+
+    /**
+     * @brief Encrypts all pending items, even if they do not fill a ciphertext.
+     * @return Queries for the pending items, split like batch encryption; empty if nothing is pending.
+     */
+    std::vector<Query> flush();
+
+    /**
+     * @brief Returns the number of items waiting for a ciphertext.
+     * @return Pending item count.
+     */
+    uint32_t getPendingCount() const;
+
+    /**
+     * @brief Returns how many items fill one ciphertext.
+     * @return Items per ciphertext, or 0 before the first item is added.
+     */
+    uint32_t getItemsPerCiphertext() const;
+
+private:
+    std::shared_ptr<detail::ItemPacker> impl_;
+};
+
+/**
+ * @brief Creates an `ItemPacker` that encrypts with the given encryptor and key pack.
+ * @param encryptor Encryptor created for an `EvalMode::RMP` context.
+ * @param keypack Key pack providing the encryption key.
+ * @param level Optional remaining multiplicative depth (default: 0).
+ * @param scale Optional custom scale factor.
+ * @return Configured `ItemPacker` instance.
+ * @throws evi::NotSupportedError if the encryptor is not in `EvalMode::RMP`.
+ */
+EVI_API ItemPacker makeItemPacker(const Encryptor &encryptor, const KeyPack &keypack, int level = 0,
+                                  std::optional<float> scale = std::nullopt);
+
+} // namespace evi
@@ -19,6 +19,7 @@
 #pragma once
 #include "EVI/Enums.hpp"
 #include "EVI/Export.hpp"
+#include <cstddef>
 #include <memory>
 #include <vector>
 
@@ -96,6 +97,30 @@ public:
      */
     static void serializeToString(const Query &query, std::string &out);
 
+    /**
+     * @brief Returns the exact number of bytes `serializeTo()` writes for a Query.
+     * @param query Query to measure.
+     * @return Serialized size in bytes.
+     */
+    static std::size_t getSerializedSize(const Query &query);
+
+    /**
+     * @brief Writes a Query straight into caller memory, without an intermediate copy.
+     * @param query Query to serialize.
+     * @param out Destination buffer.
+     * @param size Size of `out`; must equal `getSerializedSize(query)`.
+     */
+    static void serializeToBuffer(const Query &query, void *out, std::size_t size);
+
+    /**
+     * @brief Reads a Query from memory in place, without copying the input.
+     * @param data Serialized query.
+     * @param size Number of bytes at `data`.
+     * @return Deserialized Query.
+     * @throws evi::InvalidInputError if `data` ends before the serialized object does.
+     */
+    static Query deserializeFromBuffer(const void *data, std::size_t size);
+
     /**
      * @brief Writes multiple Query objects to a binary stream.
      * @param queries Sequence of queries to serialize.
@@ -124,6 +149,14 @@ public:
      */
     static std::vector<Query> deserializeVectorFromString(const std::string &data);
 
+    /**
+     * @brief Reads multiple Query objects from memory in place, without copying the input.
+     * @param data Serialized queries.
+     * @param size Number of bytes at `data`.
+     * @return Deserialized query sequence.
+     */
+    static std::vector<Query> deserializeVectorFromBuffer(const void *data, std::size_t size);
+
 private:
     std::shared_ptr<detail::Query> impl_;
 
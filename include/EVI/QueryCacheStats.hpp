@@ -0,0 +1,37 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (C) 2025, CryptoLab, Inc.                                       //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//     http://www.apache.org/licenses/LICENSE-2.0                             //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+
+namespace evi {
+
+/**
+ * @struct QueryCacheStats
+ * @brief Counters reported by the encoded-query cache of an `Encryptor`.
+ */
+struct QueryCacheStats {
+    uint64_t hits = 0;      ///< Calls served from the cache.
+    uint64_t misses = 0;    ///< Calls that had to encode.
+    uint64_t evictions = 0; ///< Entries dropped to stay within capacity.
+    uint64_t size = 0;      ///< Entries currently held.
+    uint64_t capacity = 0;  ///< Maximum number of entries (0 when disabled).
+};
+
+} // namespace evi
@@ -18,6 +18,8 @@
 
 #pragma once
 #include "EVI/Export.hpp"
+#include <cstddef>
+#include <cstdint>
 #include <istream>
 #include <memory>
 #include <optional>
@@ -27,7 +29,8 @@ namespace evi {
 
 namespace detail {
 class SearchResult;
-}
+struct ShardedSearchResult;
+} // namespace detail
 
 /**
  * @class SearchResult
@@ -62,6 +65,40 @@ public:
      */
     static void serializeTo(const SearchResult &res, std::ostream &os);
 
+    /**
+     * @brief Returns the exact number of bytes `serializeTo()` writes for a `SearchResult`.
+     * @param res The `SearchResult` instance to measure.
+     * @return Serialized size in bytes.
+     */
+    static size_t getSerializedSize(const SearchResult &res);
+
+    /**
+     * @brief Serializes a `SearchResult` straight into caller memory, without an intermediate copy.
+     * @param res The `SearchResult` instance to serialize.
+     * @param out Destination buffer.
+     * @param size Size of `out`; must equal `getSerializedSize(res)`.
+     */
+    static void serializeToBuffer(const SearchResult &res, void *out, size_t size);
+
+    /**
+     * @brief Deserializes a `SearchResult` from memory in place, without copying the input.
+     * @param data Serialized search result.
+     * @param size Number of bytes at `data`.
+     * @return A deserialized `SearchResult` instance.
+     * @throws evi::InvalidInputError if `data` ends before the serialized object does.
+     */
+    static SearchResult deserializeFromBuffer(const void *data, size_t size);
+
+    /**
+     * @brief Serializes a `SearchResult` in chunks that `Decryptor::decryptStream()` can decrypt as they arrive.
+     *
+     * `deserializeFrom()` also accepts this layout.
+     * @param res The `SearchResult` instance to serialize.
+     * @param os Output stream to write the serialized result.
+     * @param ctxts_per_chunk Number of ciphertexts (of 4096 items each) stored per chunk.
+     */
+    static void serializeChunkedTo(const SearchResult &res, std::ostream &os, uint32_t ctxts_per_chunk = 16);
+
     /**
      * @brief Returns the number of items currently stored.
      * @return Item count.
@@ -77,4 +114,53 @@ private:
     /// @endcond
 };
 
+/**
+ * @class ShardedSearchResult
+ * @brief Collects the partial search results of a database that is split across shards.
+ *
+ * Each shard is a `SearchResult` over its own items, and its item offset places those items in the
+ * global item numbering. Decrypt it with `Decryptor::decrypt()` or `Decryptor::decryptTopK()` to get
+ * globally indexed scores without concatenating the shards.
+ */
+class EVI_API ShardedSearchResult {
+public:
+    /// @brief Creates a container without shards.
+    ShardedSearchResult();
+
+    /**
+     * @brief Adds the result of one shard.
+     * @param shard Search result of the shard.
+     * @param item_offset Global index of the shard's first item. Shards may be added in any order, but together
+     * they must number the items contiguously from 0, without gaps or overlaps.
+     */
+    void addShard(const SearchResult &shard, uint64_t item_offset);
+
+    /**
+     * @brief Returns the number of shards added so far.
+     * @return Shard count.
+     */
+    size_t getShardCount() const;
+
+    /**
+     * @brief Deserializes a `ShardedSearchResult` from an input stream.
+     * @param is Input stream containing the serialized sharded result.
+     * @return A deserialized `ShardedSearchResult` instance.
+     */
+    static ShardedSearchResult deserializeFrom(std::istream &is);
+
+    /**
+     * @brief Serializes a `ShardedSearchResult` to an output stream.
+     * @param res The `ShardedSearchResult` instance to serialize.
+     * @param os Output stream to write the serialized result.
+     */
+    static void serializeTo(const ShardedSearchResult &res, std::ostream &os);
+
+private:
+    std::shared_ptr<detail::ShardedSearchResult> impl_;
+
+    /// @cond INTERNAL
+    friend const std::shared_ptr<detail::ShardedSearchResult> &getImpl(const ShardedSearchResult &) noexcept;
+    /// @endcond
+};
+
 } // namespace evi
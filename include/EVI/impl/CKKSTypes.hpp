@@ -25,6 +25,7 @@
 
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <utility>
 #include <vector>
@@ -50,6 +51,7 @@ using poly = AlignedArray<u64, DEGREE>;
 
 using polyvec = std::vector<u64, AlignedAllocator<u64, alignment_byte>>;
 using polyvec128 = std::vector<u128, AlignedAllocator<u128, alignment_byte>>;
+using polyset = std::vector<poly, AlignedAllocator<poly, alignment_byte>>;
 using polydata = u64 *;
 
 struct IQuery {
@@ -65,6 +67,10 @@ public:
     virtual void deserializeFrom(const std::vector<u8> &buf) = 0;
     virtual void serializeTo(std::ostream &stream) const = 0;
     virtual void deserializeFrom(std::istream &stream) = 0;
+    // Exact number of bytes serializeTo writes, computed from the header fields.
+    virtual u64 getSerializedSize() const = 0;
+    // Deep copy of the block, header fields included.
+    virtual std::shared_ptr<IQuery> clone() const = 0;
 
     virtual poly &getPoly(const int pos, const int level, std::optional<const int> index = std::nullopt) = 0;
     virtual const poly &getPoly(const int pos, const int level,
@@ -101,6 +107,8 @@ public:
     void deserializeFrom(const std::vector<u8> &buf) override;
     void serializeTo(std::ostream &stream) const override;
     void deserializeFrom(std::istream &stream) override;
+    u64 getSerializedSize() const override;
+    std::shared_ptr<IQuery> clone() const override;
 
     DataType &getDataType() override {
         return dtype_;
@@ -117,51 +125,50 @@ public:
         throw InvalidAccessError("Not compatible type to access to 128-bit array");
     }
 
+    // Number of polynomials held by a block of the given type and level:
+    // (b_q, a_q[, b_p, a_p]) for ciphertexts and (b_q[, b_p]) for plaintexts.
+    static constexpr int getPolyCount(const int level) {
+        return (T == DataType::CIPHER ? 2 : 1) * (level ? 2 : 1);
+    }
+
 private:
+    int getPolyIndex(const int pos, const int level) const;
+    void allocate(const int level);
+
     DataType dtype_;
     int level_;
-    poly b_q_;
-    poly b_p_;
-    poly a_q_;
-    poly a_p_;
+    // Only the components that exist at level_ are allocated, so a level-0 block
+    // does not carry the unused P-modulus halves.
+    polyset polys_;
 };
 
+// RMS encoded query. encode() produces residues mod Q, so the coefficients are kept as a single 64-bit plane.
 template <DataType T>
 struct SerializedSingleQuery : IQuery {
     SerializedSingleQuery(polyvec128 &ptxt);
+    SerializedSingleQuery(const poly &ptxt_q);
+    SerializedSingleQuery(std::istream &stream);
+    // Copies start without the widened copy and build their own on first use.
+    SerializedSingleQuery(const SerializedSingleQuery &other);
+    SerializedSingleQuery &operator=(const SerializedSingleQuery &other);
 
-    [[noreturn]] poly &getPoly(const int pos, const int level, std::optional<const int> index = std::nullopt) override {
-        throw InvalidAccessError("Not compatible type to access to 64-bit array");
-    }
-    [[noreturn]] const poly &getPoly(const int pos, const int level,
-                                     std::optional<const int> index = std::nullopt) const override {
-
-        throw InvalidAccessError("Not compatible type to access to 64-bit array");
-    }
-    [[noreturn]] polydata getPolyData(const int pos, const int leve,
-                                      std::optional<const int> index = std::nullopt) override {
-        throw InvalidAccessError("Not compatible type to access to 64-bit array");
-    }
-    [[noreturn]] polydata getPolyData(const int pos, const int level,
-                                      std::optional<const int> index = std::nullopt) const override {
-        throw InvalidAccessError("Not compatible type to access to 64-bit array");
-    }
+    // 64-bit access to the plane (pos 0, level 0).
+    poly &getPoly(const int pos, const int level, std::optional<const int> index = std::nullopt) override;
+    const poly &getPoly(const int pos, const int level, std::optional<const int> index = std::nullopt) const override;
+    polydata getPolyData(const int pos, const int leve, std::optional<const int> index = std::nullopt) override;
+    polydata getPolyData(const int pos, const int level, std::optional<const int> index = std::nullopt) const override;
 
+    // Widened read-only copy for 128-bit consumers, built exactly once on first use so a block shared between
+    // threads can be read from all of them.
     polyvec128 &getPoly() override;
     u128 *getPolyData() override;
 
-    void serializeTo(std::vector<u8> &buf) const override {
-        throw InvalidAccessError("Not compatible type to access to 64-bit array");
-    }
-    void deserializeFrom(const std::vector<u8> &buf) override {
-        throw InvalidAccessError("Not compatible type to access to 64-bit array");
-    }
-    void serializeTo(std::ostream &stream) const override {
-        throw InvalidAccessError("Not compatible type to access to 64-bit array");
-    }
-    void deserializeFrom(std::istream &stream) override {
-        throw InvalidAccessError("Not compatible type to access to 64-bit array");
-    }
+    void serializeTo(std::vector<u8> &buf) const override;
+    void deserializeFrom(const std::vector<u8> &buf) override;
+    void serializeTo(std::ostream &stream) const override;
+    void deserializeFrom(std::istream &stream) override;
+    u64 getSerializedSize() const override;
+    std::shared_ptr<IQuery> clone() const override;
 
     DataType &getDataType() override {
         return dtype_;
@@ -171,9 +178,14 @@ struct SerializedSingleQuery : IQuery {
     }
 
 private:
+    void checkPlaneAccess(const int pos, const int level) const;
+    void widen();
+
     DataType dtype_;
     int level_;
-    polyvec128 ptxt_;
+    poly lo_;
+    std::once_flag wide_once_;
+    polyvec128 wide_;
 };
 
 class Query {
@@ -283,9 +295,9 @@ private:
 
 struct IData {
 public:
-    u64 dim;
-    u64 degree;
-    u64 n;
+    u64 dim = 0;
+    u64 degree = 0;
+    u64 n = 0;
 
     virtual polyvec &getPoly(const int pos, const int level, std::optional<const int> index = std::nullopt) = 0;
     virtual const polyvec &getPoly(const int pos, const int level,
@@ -298,6 +310,8 @@ public:
     virtual void deserializeFrom(const std::vector<u8> &buf) = 0;
     virtual void serializeTo(std::ostream &stream) const = 0;
     virtual void deserializeFrom(std::istream &stream) = 0;
+    // Exact number of bytes serializeTo writes, computed from the header fields.
+    virtual u64 getSerializedSize() const = 0;
 
     virtual void setSize(const int size, std::optional<int> = std::nullopt) = 0;
 
@@ -323,6 +337,7 @@ public:
     void deserializeFrom(const std::vector<u8> &buf) override;
     void serializeTo(std::ostream &stream) const override;
     void deserializeFrom(std::istream &stream) override;
+    u64 getSerializedSize() const override;
 
     void setSize(const int size, std::optional<int> = std::nullopt) override;
     DataType &getDataType() override {
@@ -383,6 +398,12 @@ private:
     std::shared_ptr<IPSearchResult> ipsearch_;
 };
 
+// Partial results of a database split across shards; shards[i] holds the items numbered from item_offsets[i].
+struct ShardedSearchResult {
+    std::vector<SearchResult> shards;
+    std::vector<u64> item_offsets;
+};
+
 using DataState = std::shared_ptr<IData>;
 using Blob = std::vector<DataState>;
 
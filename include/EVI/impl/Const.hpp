@@ -44,6 +44,9 @@ static constexpr u32 LOG_TILE_DIM = 5;
 static constexpr u32 TILE_DIM = 1U << LOG_TILE_DIM;
 static constexpr u32 BLOCK_ROWS = 8;
 
+// rows gathered per pass when transposing MM inputs (16 floats = one 64-byte cache line per item)
+constexpr u32 MM_TILE_ROWS = 16;
+
 constexpr static u32 LOG_THREAD_NTT_SIZE = 3;
 constexpr static u32 LOG_FIRST_RADIX = 6;
 constexpr static u32 LOG_THREAD_N = 6;
@@ -20,14 +20,19 @@
 
 #include "EVI/impl/CKKSTypes.hpp"
 #include "EVI/impl/ContextImpl.hpp"
+#include "EVI/impl/SecretKeyCache.hpp"
 #include "EVI/impl/SecretKeyImpl.hpp"
 #include "EVI/impl/Type.hpp"
+#include "utils/DebUtils.hpp"
 #include "utils/Exceptions.hpp"
 #include "utils/span.hpp"
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <istream>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <utility>
@@ -39,6 +44,21 @@
 namespace evi {
 
 namespace detail {
+// Decryption state used by one thread at a time and reused for every ciphertext it decrypts, so the
+// per-ciphertext path neither builds a deb::Ciphertext nor allocates a message buffer.
+struct DecryptWorker {
+    explicit DecryptWorker(const Context &context);
+
+    // Decrypts the ciphertext at the given polynomials into buf; a_p/b_p are only read for level 1.
+    void decrypt(const SecretKey &key, const double scale, u64 *a_q, u64 *b_q, u64 *a_p = nullptr,
+                 u64 *b_p = nullptr, bool is_ntt = true);
+
+    deb::Decryptor decryptor;
+    utils::DebCipherView view_q;
+    utils::DebCipherView view_qp;
+    deb::CoeffMessage buf;
+};
+
 class DecryptorInterface {
 public:
     explicit DecryptorInterface(const Context &context);
@@ -50,6 +70,14 @@ public:
                             std::optional<double> scale = std::nullopt) = 0;
     virtual Message decrypt(const SearchResult ctxt, std::istream &key_stream, bool is_score,
                             std::optional<double> scale = std::nullopt) = 0;
+    // Number of floats decrypt(SearchResult, ...) produces, i.e. the capacity decryptTo needs.
+    virtual u64 getDecryptSize(const SearchResult ctxt) const = 0;
+    // Decrypts into the caller's buffer and returns the number of floats written; throws if out is too small.
+    virtual u64 decryptTo(const SearchResult ctxt, const SecretKey &key, bool is_score, span<float> out,
+                          std::optional<double> scale = std::nullopt) = 0;
+    // Decrypts several results in one call, sharing the per-call setup; results[i] decrypts into the i-th Message.
+    virtual std::vector<Message> decryptBatch(span<const SearchResult *> results, const SecretKey &key, bool is_score,
+                                              std::optional<double> scale = std::nullopt);
     virtual Message decrypt(const Query &ctxt, const SecretKey &key, std::optional<double> scale = std::nullopt) = 0;
     virtual Message decrypt(const Query &ctxt, const std::string &key_path,
                             std::optional<double> scale = std::nullopt) = 0;
@@ -57,10 +85,77 @@ public:
                             std::optional<double> scale = std::nullopt) = 0;
     virtual Message decrypt(const int idx, const Query &ctxt, const SecretKey &key,
                             std::optional<double> scale = std::nullopt);
+    // Every item of a batched query, decrypting its ciphertexts once; items[idx] equals decrypt(idx, ...).
+    virtual std::vector<Message> decryptItems(const Query &ctxt, const SecretKey &key,
+                                              std::optional<double> scale = std::nullopt);
+    // The items at indices, in that order; only their coefficients are read out of each decrypted ciphertext.
+    virtual std::vector<Message> decryptItems(const Query &ctxt, const SecretKey &key, const std::vector<u64> &indices,
+                                              std::optional<double> scale = std::nullopt);
+    // The k highest scores of a search result as (item index, score), best first; ties keep the lower index.
+    virtual std::vector<std::pair<u64, float>> decryptTopK(const SearchResult ctxt, const SecretKey &key, const u64 k,
+                                                           std::optional<double> scale = std::nullopt);
+    // Every score strictly above threshold as (item index, score), in index order.
+    virtual std::vector<std::pair<u64, float>> decryptAbove(const SearchResult ctxt, const SecretKey &key,
+                                                            const float threshold,
+                                                            std::optional<double> scale = std::nullopt);
+    // The max_count best scores strictly above threshold, ordered as in decryptTopK.
+    virtual std::vector<std::pair<u64, float>> decryptAboveTopK(const SearchResult ctxt, const SecretKey &key,
+                                                                const float threshold, const u64 max_count,
+                                                                std::optional<double> scale = std::nullopt);
+    // Scores of every shard at their global item index; the shards must cover the items contiguously from 0.
+    virtual Message decryptSharded(const ShardedSearchResult &res, const SecretKey &key,
+                                   std::optional<double> scale = std::nullopt);
+    // The k highest scores over all shards, with global item indices, ordered as in decryptTopK.
+    virtual std::vector<std::pair<u64, float>> decryptShardedTopK(const ShardedSearchResult &res,
+                                                                  const SecretKey &key, const u64 k,
+                                                                  std::optional<double> scale = std::nullopt);
+    // Decrypts a result written by utils::serializeResultChunkedTo while it is still being read, calling
+    // on_chunk(item offset, values) once per chunk; only two chunks are held in memory at a time. A planar result
+    // (utils::serializeResultTo) is read chunk by chunk when the stream is seekable. Otherwise all planes but the
+    // last are read up front and the last one is streamed.
+    virtual void decryptStream(std::istream &is, const SecretKey &key, bool is_score,
+                               const std::function<void(u64, span<float>)> &on_chunk,
+                               std::optional<double> scale = std::nullopt);
+
+    // Bounded cache of keys loaded by the path/stream overloads; a capacity of 0 disables it and wipes its keys.
+    void setSecretKeyCacheCapacity(const std::size_t capacity);
+    SecretKeyCache::Stats getSecretKeyCacheStats() const;
+    // Upper bound on the threads that decrypt one SearchResult; 0 uses the whole global pool, 1 runs sequentially.
+    void setNumThreads(const u32 num_threads);
 
 protected:
-    deb::Decryptor deb_dec_;
+    // Workers taken out of the idle pool for the duration of one call and handed back when the lease ends, so
+    // concurrent calls on one decryptor never share a worker.
+    class WorkerLease {
+    public:
+        WorkerLease(DecryptorInterface &owner, const u32 count);
+        ~WorkerLease();
+        WorkerLease(const WorkerLease &) = delete;
+        WorkerLease &operator=(const WorkerLease &) = delete;
+
+        DecryptWorker &operator[](const u32 index) {
+            return *workers_[index];
+        }
+
+    private:
+        DecryptorInterface &owner_;
+        std::vector<std::unique_ptr<DecryptWorker>> workers_;
+    };
+
+    SecretKey loadSecKey(const std::string &key_path);
+    SecretKey loadSecKey(std::istream &key_stream);
+    // Number of workers runDecryptJobs uses for num_jobs jobs.
+    u32 numWorkers(const u64 num_jobs) const;
+    // Runs job(j, worker index, worker) for every j < num_jobs, spread over num_workers leased workers.
+    void runDecryptJobs(const u64 num_jobs, const u32 num_workers,
+                        const std::function<void(u64, u32, DecryptWorker &)> &job);
+    void runDecryptJobs(const u64 num_jobs, const std::function<void(u64, u32, DecryptWorker &)> &job);
+
     const Context context_;
+    SecretKeyCache key_cache_{0};
+    std::atomic<u32> num_threads_{0};
+    std::mutex worker_mutex_;
+    std::vector<std::unique_ptr<DecryptWorker>> idle_workers_;
 };
 
 class DecryptorFLAT : public DecryptorInterface {
@@ -73,10 +168,55 @@ public:
                     std::optional<double> scale = std::nullopt) override;
     Message decrypt(const SearchResult ctxt, std::istream &key_stream, bool is_score,
                     std::optional<double> scale = std::nullopt) override;
+    u64 getDecryptSize(const SearchResult ctxt) const override;
+    u64 decryptTo(const SearchResult ctxt, const SecretKey &key, bool is_score, span<float> out,
+                  std::optional<double> scale = std::nullopt) override;
+    std::vector<Message> decryptBatch(span<const SearchResult *> results, const SecretKey &key, bool is_score,
+                                      std::optional<double> scale = std::nullopt) override;
     Message decrypt(const Query &ctxt, const SecretKey &key, std::optional<double> scale = std::nullopt) override;
     Message decrypt(const Query &ctxt, const std::string &key_path,
                     std::optional<double> scale = std::nullopt) override;
     Message decrypt(const Query &ctxt, std::istream &key_stream, std::optional<double> scale = std::nullopt) override;
+    std::vector<std::pair<u64, float>> decryptTopK(const SearchResult ctxt, const SecretKey &key, const u64 k,
+                                                   std::optional<double> scale = std::nullopt) override;
+    std::vector<std::pair<u64, float>> decryptAbove(const SearchResult ctxt, const SecretKey &key,
+                                                    const float threshold,
+                                                    std::optional<double> scale = std::nullopt) override;
+    std::vector<std::pair<u64, float>> decryptAboveTopK(const SearchResult ctxt, const SecretKey &key,
+                                                        const float threshold, const u64 max_count,
+                                                        std::optional<double> scale = std::nullopt) override;
+    void decryptStream(std::istream &is, const SecretKey &key, bool is_score,
+                       const std::function<void(u64, span<float>)> &on_chunk,
+                       std::optional<double> scale = std::nullopt) override;
+    Message decryptSharded(const ShardedSearchResult &res, const SecretKey &key,
+                           std::optional<double> scale = std::nullopt) override;
+    std::vector<std::pair<u64, float>> decryptShardedTopK(const ShardedSearchResult &res, const SecretKey &key,
+                                                          const u64 k,
+                                                          std::optional<double> scale = std::nullopt) override;
+
+protected:
+    // The k best scores over results, whose items are numbered from item_offsets; shared by decryptTopK,
+    // decryptShardedTopK and decryptAboveTopK. Without a threshold every score is a candidate, -inf and NaN included.
+    std::vector<std::pair<u64, float>> selectTopScores(span<SearchResult> results,
+                                                       const std::vector<u64> &item_offsets, const SecretKey &key,
+                                                       const u64 k, std::optional<float> threshold,
+                                                       std::optional<double> scale);
+    // Number of real items in a result: its total item count, bounded by what its ciphertexts can hold.
+    u64 getItemCount(const SearchResult &ip_res) const;
+    // Copies the decrypted worker buffer to dst, reordering it into score order when is_score is set.
+    void extractResult(const deb::CoeffMessage &buf, bool is_score, float *dst) const;
+    // Decrypts the result ciphertext starting at offset into worker.buf.
+    void decryptResultCtxt(IData &ctxt, const u64 offset, const SecretKey &key, DecryptWorker &worker,
+                           const double scale);
+    // decryptStream for a planar result on a stream that cannot seek; is is positioned at the first plane.
+    void decryptPlanarSequential(std::istream &is, const int level, const u64 num_ctxt, const u64 ctxts_per_chunk,
+                                 const u64 num_items, const SecretKey &key, bool is_score,
+                                 const std::function<void(u64, span<float>)> &on_chunk,
+                                 std::optional<double> scale);
+    void buildScoreSlots();
+
+    // score_slots_[j] is the coefficient that holds the j-th score of a result ciphertext.
+    std::vector<u32> score_slots_;
 };
 
 class DecryptorRMP : public DecryptorFLAT {
@@ -87,6 +227,18 @@ public:
 
     Message decrypt(const int idx, const Query &ctxt, const SecretKey &key,
                     std::optional<double> scale = std::nullopt) override;
+
+    std::vector<Message> decryptItems(const Query &ctxt, const SecretKey &key,
+                                      std::optional<double> scale = std::nullopt) override;
+    std::vector<Message> decryptItems(const Query &ctxt, const SecretKey &key, const std::vector<u64> &indices,
+                                      std::optional<double> scale = std::nullopt) override;
+
+private:
+    // Number of items ctxt holds: n for a batched ITEM query, 1 for a QUERY-encoded one.
+    static u64 getQueryItemCount(const Query &ctxt);
+    // Writes item indices[k] of ctxt to out[k], decrypting each ciphertext once.
+    void decryptQueryItems(const Query &ctxt, const SecretKey &key, std::optional<double> scale,
+                           span<u64> indices, Message *out);
 };
 
 class DecryptorMM : public DecryptorInterface {
@@ -99,10 +251,20 @@ public:
                     std::optional<double> scale = std::nullopt) override;
     Message decrypt(const SearchResult ctxt, std::istream &key_stream, bool is_score,
                     std::optional<double> scale = std::nullopt) override;
+    u64 getDecryptSize(const SearchResult ctxt) const override;
+    u64 decryptTo(const SearchResult ctxt, const SecretKey &key, bool is_score, span<float> out,
+                  std::optional<double> scale = std::nullopt) override;
+    std::vector<Message> decryptBatch(span<const SearchResult *> results, const SecretKey &key, bool is_score,
+                                      std::optional<double> scale = std::nullopt) override;
     Message decrypt(const Query &ctxt, const SecretKey &key, std::optional<double> scale = std::nullopt) override;
     Message decrypt(const Query &ctxt, const std::string &key_path,
                     std::optional<double> scale = std::nullopt) override;
     Message decrypt(const Query &ctxt, std::istream &key_stream, std::optional<double> scale = std::nullopt) override;
+
+private:
+    // Decrypts ciphertext t of the row-major (row, item) order into dst.
+    void decryptMatrixCtxt(IData &matrix, const u64 t, const u64 item_count, const SecretKey &key,
+                           const double delta, DecryptWorker &worker, float *dst);
 };
 
 class Decryptor : public std::shared_ptr<DecryptorInterface> {
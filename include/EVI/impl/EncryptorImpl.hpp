@@ -22,8 +22,11 @@
 #include "EVI/impl/CKKSTypes.hpp"
 #include "EVI/impl/ContextImpl.hpp"
 #include "EVI/impl/KeyPackImpl.hpp"
+#include "EVI/impl/QueryCache.hpp"
 #include "EVI/impl/SecretKeyImpl.hpp"
 #include "EVI/impl/Type.hpp"
+#include "utils/Convert.hpp"
+#include "utils/DebUtils.hpp"
 #include "utils/Exceptions.hpp"
 #include "utils/Sampler.hpp"
 #include "utils/span.hpp"
@@ -31,6 +34,8 @@
 #include <cstdint>
 #include <functional>
 #include <istream>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <utility>
@@ -43,6 +48,18 @@
 
 namespace evi {
 namespace detail {
+
+// A deb encryptor with the ciphertext views and message buffer it encrypts through, so encrypting a block allocates
+// nothing.
+struct EncryptWorker {
+    EncryptWorker(const Context &context, const std::optional<std::vector<u8>> &seed);
+
+    deb::Encryptor encryptor;
+    utils::DebCipherView view_q;
+    utils::DebCipherView view_qp;
+    deb::CoeffMessage buf;
+};
+
 class EncryptorInterface {
 public:
     virtual ~EncryptorInterface() = default;
@@ -93,8 +110,47 @@ public:
     virtual Blob encode(const span<float> msg, const int num_items, const bool level = false,
                         std::optional<float> scale = std::nullopt) = 0;
 
+    // Quantized inputs. Values are converted slice by slice straight into the per-ciphertext encode buffers, so no
+    // fp32 copy of the whole vector is ever made.
+    Query encode(const span<u16> msg, const HalfFormat format, const EncodeType type = EncodeType::ITEM,
+                 const bool level = false, std::optional<float> scale = std::nullopt);
+    Query encode(const span<i8> msg, const float quant_scale, const EncodeType type = EncodeType::ITEM,
+                 const bool level = false, std::optional<float> scale = std::nullopt);
+    Query encrypt(const span<u16> msg, const HalfFormat format, const KeyPack &keypack,
+                  const EncodeType type = EncodeType::ITEM, const bool level = false,
+                  std::optional<float> scale = std::nullopt);
+    Query encrypt(const span<i8> msg, const float quant_scale, const KeyPack &keypack,
+                  const EncodeType type = EncodeType::ITEM, const bool level = false,
+                  std::optional<float> scale = std::nullopt);
+
+    // L2-normalized inputs. The reciprocal norm is folded into the encoding scale, so the vector is normalized inside
+    // the conversion loop instead of in a separate pass. norm(s) receive the L2 norm of each input when non-null.
+    virtual Query encodeNormalized(const span<float> msg, const EncodeType type = EncodeType::ITEM,
+                                   const bool level = false, std::optional<float> scale = std::nullopt,
+                                   float *norm = nullptr) = 0;
+    virtual Query encryptNormalized(const span<float> msg, const KeyPack &keypack,
+                                    const EncodeType type = EncodeType::ITEM, const bool level = false,
+                                    std::optional<float> scale = std::nullopt, float *norm = nullptr) = 0;
+    virtual std::vector<Query> encryptNormalized(const std::vector<std::vector<float>> &msg, const KeyPack &keypack,
+                                                 const EncodeType type = EncodeType::ITEM, const bool level = false,
+                                                 std::optional<float> scale = std::nullopt,
+                                                 std::vector<float> *norms = nullptr) = 0;
+
+    // Bounded LRU cache for encode(span, ...); a capacity of 0 disables and releases it.
+    virtual void setQueryCacheCapacity(const std::size_t capacity) = 0;
+    virtual QueryCacheStats getQueryCacheStats() const = 0;
+    // FLAT only: batch encryption packs DEGREE / nextPowerOfTwo(dim) vectors into each ciphertext.
+    virtual void setFlatItemPacking(const bool enable) = 0;
+
     virtual EvalMode getEvalMode() const = 0;
     virtual const Context &getContext() const = 0;
+
+protected:
+    // Single-vector encode and encrypt for any input format; the span<float> overloads forward here as well.
+    virtual Query encodeInput(const utils::InputVector &msg, const EncodeType type, const bool level,
+                              std::optional<float> scale) = 0;
+    virtual Query encryptInput(const utils::InputVector &msg, const KeyPack &keypack, const EncodeType type,
+                               const bool level, std::optional<float> scale) = 0;
 };
 
 class RandomSampler;
@@ -114,6 +170,9 @@ public:
     void loadEncKey(std::istream &in) override;
     void loadEncKey(const KeyPack &keypack);
 
+    using EncryptorInterface::encode;
+    using EncryptorInterface::encrypt;
+
     Query encrypt(const span<float> msg, const SecretKey &seckey, const EncodeType type = EncodeType::ITEM,
                   const bool level = false, std::optional<float> scale = std::nullopt) override;
     Query encrypt(const span<float> msg, const MultiSecretKey &seckey, const EncodeType type, const bool level,
@@ -142,8 +201,10 @@ public:
                                const EncodeType type = EncodeType::ITEM, const bool level = false,
                                std::optional<float> scale = std::nullopt) override;
 
+    // gains, when given, holds one multiplier per input vector (see encryptNormalized).
     std::vector<Query> encryptMM(const std::vector<std::vector<float>> &msg, const EncodeType type = EncodeType::ITEM,
-                                 const bool level = false, std::optional<float> scale = std::nullopt);
+                                 const bool level = false, std::optional<float> scale = std::nullopt,
+                                 const double *gains = nullptr);
 
     Query encode(const span<float> msg, const EncodeType type, const bool level = false,
                  std::optional<float> scale = std::nullopt) override;
@@ -151,6 +212,18 @@ public:
     Query encode(const std::vector<std::vector<float>> &msg, const EncodeType type, const int level,
                  std::optional<float> scale) override;
 
+    Query encodeNormalized(const span<float> msg, const EncodeType type, const bool level,
+                           std::optional<float> scale, float *norm) override;
+    Query encryptNormalized(const span<float> msg, const KeyPack &keypack, const EncodeType type, const bool level,
+                            std::optional<float> scale, float *norm) override;
+    std::vector<Query> encryptNormalized(const std::vector<std::vector<float>> &msg, const KeyPack &keypack,
+                                         const EncodeType type, const bool level, std::optional<float> scale,
+                                         std::vector<float> *norms) override;
+
+    void setQueryCacheCapacity(const std::size_t capacity) override;
+    QueryCacheStats getQueryCacheStats() const override;
+    void setFlatItemPacking(const bool enable) override;
+
     EvalMode getEvalMode() const override {
         return context_->getEvalMode();
     }
@@ -167,21 +240,64 @@ public:
 
     // std::vector<u64> packingWithModPackKey(KeyPack keys,
     //                                        std::vector<std::shared_ptr<evi::SingleCiphertext>> ciphers);
+protected:
+    Query encodeInput(const utils::InputVector &msg, const EncodeType type, const bool level,
+                      std::optional<float> scale) override;
+    Query encryptInput(const utils::InputVector &msg, const KeyPack &keypack, const EncodeType type, const bool level,
+                       std::optional<float> scale) override;
+
 private:
+    // normalize scales the vector to unit length while it is placed into the encode buffers; norm(s), when non-null,
+    // receive the L2 norm of each input.
+    Query encryptInput(const utils::InputVector &msg, const EncodeType type, const bool level,
+                       std::optional<float> scale, const bool normalize = false, float *norm = nullptr);
+    Query encodeUncached(const utils::InputVector &msg, const EncodeType type, const bool level,
+                         std::optional<float> scale, const bool normalize = false, float *norm = nullptr);
+    // Batch encrypt for every mode but MM.
+    std::vector<Query> encryptBatch(const std::vector<std::vector<float>> &msg, const EncodeType type,
+                                    const bool level, std::optional<float> scale, const bool normalize,
+                                    std::vector<float> *norms);
+    std::vector<Query> encryptPackedFlat(const std::vector<std::vector<float>> &msg, const EncodeType type,
+                                         const bool level, std::optional<float> scale, const bool normalize = false,
+                                         std::vector<float> *norms = nullptr);
+    // worker selects a leased encrypt worker; nullptr uses main_worker_.
     Query::SingleQuery innerEncrypt(const span<float> &msg, const bool level, const double scale,
                                     std::optional<const SecretKey> seckey = std::nullopt,
-                                    std::optional<bool> ntt = true);
+                                    std::optional<bool> ntt = true, EncryptWorker *worker = nullptr);
     Query::SingleQuery innerEncode(const span<float> &msg, const bool level, const double scale,
                                    std::optional<const u64> msg_size = std::nullopt, std::optional<bool> ntt = true);
+    // Number of workers to use for num_jobs independent ciphertexts. 1 means run sequentially on main_worker_,
+    // which is always the case for a seeded encryptor so that its output stays reproducible.
+    u32 numEncryptWorkers(const u64 num_jobs) const;
+    // Takes num_workers encryptors out of the idle pool (creating missing ones) and hands them back afterwards.
+    std::vector<std::unique_ptr<EncryptWorker>> leaseWorkerEncryptors(const u32 num_workers);
+    void returnWorkerEncryptors(std::vector<std::unique_ptr<EncryptWorker>> &&workers);
+    // Runs job(j, worker) for every j < num_jobs, in parallel when worker encryptors are available.
+    void runEncryptJobs(const u64 num_jobs, const std::function<void(u64, EncryptWorker *)> &job);
+    // Same as innerEncrypt/innerEncode, but write the polynomials to caller-owned storage (e.g. a Matrix slice).
+    // The P pointers are only used when level is set.
+    void innerEncryptTo(const span<float> &msg, const bool level, const double scale, polydata a_q, polydata b_q,
+                        polydata a_p, polydata b_p, std::optional<const SecretKey> seckey = std::nullopt,
+                        std::optional<bool> ntt = true, EncryptWorker *worker = nullptr);
+    void innerEncodeTo(const span<float> &msg, const bool level, const double scale, polydata q, polydata p,
+                       std::optional<const u64> msg_size = std::nullopt, std::optional<bool> ntt = true);
 
     const Context context_;
     RandomSampler sampler_;
-    deb::Encryptor deb_encryptor_;
+    // Serves the sequential path, and every job of a seeded encryptor.
+    EncryptWorker main_worker_;
     FixedKeyType encKey_;
     deb::SwitchKey deb_enc_key_;
 
     VariadicKeyType switch_key_;
     bool enc_loaded_ = false;
+
+    QueryCache query_cache_{0};
+    bool flat_packing_ = false;
+
+    bool seeded_ = false;
+    std::mutex worker_mutex_;
+    std::vector<std::unique_ptr<EncryptWorker>> idle_encryptors_;
 };
 
 class Encryptor : public std::shared_ptr<EncryptorInterface> {
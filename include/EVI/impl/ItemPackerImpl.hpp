@@ -0,0 +1,64 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (C) 2025, CryptoLab, Inc.                                       //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//     http://www.apache.org/licenses/LICENSE-2.0                             //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include "EVI/impl/CKKSTypes.hpp"
+#include "EVI/impl/EncryptorImpl.hpp"
+#include "EVI/impl/KeyPackImpl.hpp"
+#include "EVI/impl/Type.hpp"
+
+#include <optional>
+#include <vector>
+
+namespace evi {
+namespace detail {
+
+// Accumulates RMP items across calls and encrypts a ciphertext only once it is full. Whatever is left over is
+// encrypted by flush() with the same power-of-two split as batch encryption.
+class ItemPacker {
+public:
+    ItemPacker(const Encryptor &encryptor, const KeyPack &keypack, const bool level = false,
+               std::optional<float> scale = std::nullopt);
+
+    // Returns the queries for every ciphertext filled by these items; the rest stays pending.
+    std::vector<Query> add(const std::vector<std::vector<float>> &items);
+    std::vector<Query> flush();
+
+    u32 getPendingCount() const {
+        return static_cast<u32>(pending_.size());
+    }
+    // 0 until the first item fixes the dimension.
+    u32 getItemsPerCiphertext() const {
+        return items_per_ctxt_;
+    }
+
+private:
+    Encryptor encryptor_;
+    KeyPack keypack_;
+    bool level_;
+    std::optional<float> scale_;
+
+    u64 dim_ = 0;
+    u32 items_per_ctxt_ = 0;
+    std::vector<std::vector<float>> pending_;
+};
+
+} // namespace detail
+} // namespace evi
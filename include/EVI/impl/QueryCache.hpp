@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (C) 2025, CryptoLab, Inc.                                       //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//     http://www.apache.org/licenses/LICENSE-2.0                             //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include "EVI/Enums.hpp"
+#include "EVI/QueryCacheStats.hpp"
+#include "EVI/impl/CKKSTypes.hpp"
+#include "EVI/impl/Type.hpp"
+#include "utils/Convert.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace evi {
+namespace detail {
+
+/**
+ * Bounded LRU cache of encoded queries, keyed by the raw input bytes, their format and the encode parameters.
+ * The cache keeps private copies of the blocks it is given and hands out fresh copies on every hit, so callers may
+ * modify what they get back. A capacity of 0 disables it.
+ */
+class QueryCache {
+public:
+    explicit QueryCache(const std::size_t capacity);
+
+    bool enabled() const {
+        return capacity_.load(std::memory_order_relaxed) != 0;
+    }
+
+    std::optional<Query> find(const utils::InputVector &msg, const EncodeType type, const int level,
+                              const std::optional<float> scale);
+    void insert(const utils::InputVector &msg, const EncodeType type, const int level,
+                const std::optional<float> scale, const Query &query);
+
+    void setCapacity(const std::size_t capacity);
+    QueryCacheStats getStats() const;
+    void clear();
+
+private:
+    struct Key {
+        u64 hash;
+        EncodeType type;
+        int level;
+        std::optional<float> scale;
+        u64 format;
+        std::vector<u8> msg;
+
+        bool operator==(const Key &other) const;
+    };
+    using Entry = std::pair<Key, Query>;
+
+    static Key makeKey(const utils::InputVector &msg, const EncodeType type, const int level,
+                       const std::optional<float> scale);
+    std::list<Entry>::iterator lookup(const Key &key);
+    void evictToCapacity();
+
+    std::atomic<std::size_t> capacity_; // written under mtx_, read without it by enabled()
+    std::list<Entry> entries_; // most recently used first
+    std::unordered_multimap<u64, std::list<Entry>::iterator> index_; // keyed by Key::hash
+    u64 hits_ = 0;
+    u64 misses_ = 0;
+    u64 evictions_ = 0;
+    mutable std::mutex mtx_;
+};
+
+} // namespace detail
+} // namespace evi
@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (C) 2025, CryptoLab, Inc.                                       //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//     http://www.apache.org/licenses/LICENSE-2.0                             //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include "EVI/impl/ContextImpl.hpp"
+#include "EVI/impl/SecretKeyImpl.hpp"
+#include "EVI/impl/Type.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <istream>
+#include <list>
+#include <mutex>
+#include <string>
+
+namespace evi {
+namespace detail {
+
+/**
+ * Bounded LRU cache of unpacked secret keys, keyed by their serialized bytes.
+ * A hit is only returned after the stored bytes compare equal to the requested ones, so a key that changes on disk
+ * is reloaded. Evicted entries wipe their serialized bytes at once and their unpacked key material as soon as the
+ * last decryption holding it returns. A capacity of 0 disables it; the cache itself stays allocated, so loads running
+ * concurrently with a capacity change never see it go away.
+ */
+class SecretKeyCache {
+public:
+    struct Stats {
+        u64 hits = 0;
+        u64 misses = 0;
+        u64 evictions = 0;
+        std::size_t size = 0;
+        std::size_t capacity = 0;
+    };
+
+    explicit SecretKeyCache(const std::size_t capacity);
+    ~SecretKeyCache();
+
+    bool enabled() const {
+        return capacity_.load(std::memory_order_relaxed) != 0;
+    }
+
+    SecretKey load(const Context &context, const std::string &key_path);
+    SecretKey load(const Context &context, std::istream &key_stream);
+
+    void setCapacity(const std::size_t capacity);
+    Stats getStats() const;
+    // Wipes every cached key and resets the counters.
+    void clear();
+
+private:
+    struct Entry {
+        std::size_t hash;
+        std::string bytes;
+        SecretKey key;
+    };
+
+    SecretKey findOrInsert(const Context &context, std::string &bytes);
+    void evictToCapacity();
+
+    std::atomic<std::size_t> capacity_; // written under mtx_, read without it by enabled()
+    std::list<Entry> entries_; // most recently used first
+    u64 hits_ = 0;
+    u64 misses_ = 0;
+    u64 evictions_ = 0;
+    mutable std::mutex mtx_;
+};
+
+// Overwrites size bytes at data with zeros in a way the compiler may not elide.
+void secureWipe(void *data, const std::size_t size);
+
+} // namespace detail
+} // namespace evi
@@ -31,7 +31,9 @@ using u64 = uint64_t;
 using i64 = int64_t;
 using u32 = uint32_t;
 using i32 = int32_t;
+using u16 = uint16_t;
 using u8 = uint8_t;
+using i8 = int8_t;
 // NOLINTEND(readability-identifier-naming)
 
 #define U64C(x) UINT64_C(x)
@@ -0,0 +1,109 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (C) 2025, CryptoLab, Inc.                                       //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//     http://www.apache.org/licenses/LICENSE-2.0                             //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "utils/Exceptions.hpp"
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+
+namespace evi {
+namespace detail {
+namespace utils {
+
+// Output buffer over fixed caller memory; writing past its end fails the stream.
+class FixedBufferStreamBuf : public std::streambuf {
+public:
+    FixedBufferStreamBuf(char *data, std::size_t size) {
+        setp(data, data + size);
+    }
+
+    std::size_t written() const {
+        return static_cast<std::size_t>(pptr() - pbase());
+    }
+};
+
+// Input buffer that reads caller memory in place, so deserializing does not copy the input first. It is seekable,
+// so tellg/seekg work as they do on a stringstream.
+class SpanStreamBuf : public std::streambuf {
+public:
+    SpanStreamBuf(const char *data, std::size_t size) {
+        char *begin = const_cast<char *>(data);
+        setg(begin, begin, begin + size);
+    }
+
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+        if (!(which & std::ios_base::in)) {
+            return pos_type(off_type(-1));
+        }
+        const off_type size = egptr() - eback();
+        off_type pos = off;
+        if (dir == std::ios_base::cur) {
+            pos += gptr() - eback();
+        } else if (dir == std::ios_base::end) {
+            pos += size;
+        }
+        if (pos < 0 || pos > size) {
+            return pos_type(off_type(-1));
+        }
+        setg(eback(), eback() + pos, egptr());
+        return pos_type(pos);
+    }
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+};
+
+// Runs read(is) over data[0, size) in place; throws if read runs past the end of the input.
+template <typename ReadFn>
+void deserializeFromBuffer(const char *data, std::size_t size, const ReadFn &read) {
+    SpanStreamBuf buf(data, size);
+    std::istream is(&buf);
+    is.exceptions(std::ios::badbit);
+    read(is);
+    if (is.fail()) {
+        throw evi::InvalidInputError("Serialized input is truncated");
+    }
+}
+
+// Runs write(os) straight into out[0, size); size must be exactly what write produces.
+template <typename WriteFn>
+void serializeToBuffer(char *out, std::size_t size, const WriteFn &write) {
+    FixedBufferStreamBuf buf(out, size);
+    std::ostream os(&buf);
+    write(os);
+    if (!os || buf.written() != size) {
+        throw evi::InvalidInputError("Serialization buffer does not match the serialized size");
+    }
+}
+
+// Appends the size bytes write(os) produces to a byte container, growing it once so it never reallocates.
+template <typename Container, typename WriteFn>
+void serializeAppend(Container &out, const std::size_t size, const WriteFn &write) {
+    const std::size_t offset = out.size();
+    out.resize(offset + size);
+    serializeToBuffer(reinterpret_cast<char *>(out.data()) + offset, size, write);
+}
+
+} // namespace utils
+} // namespace detail
+} // namespace evi
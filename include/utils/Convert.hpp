@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (C) 2025, CryptoLab, Inc.                                       //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//     http://www.apache.org/licenses/LICENSE-2.0                             //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include "EVI/Enums.hpp"
+#include "EVI/impl/Type.hpp"
+#include "utils/span.hpp"
+
+namespace evi {
+namespace detail {
+namespace utils {
+
+// Widen quantized input vectors to fp32. The loops are branch-free so the compiler can vectorize them.
+void convertHalfToFloat(const u16 *src, const u64 size, const HalfFormat format, float *dst);
+void convertInt8ToFloat(const i8 *src, const u64 size, const float quant_scale, float *dst);
+
+// Read-only view of one input vector in any accepted element format. Encoders convert slices of it directly into the
+// per-ciphertext buffer they fill anyway, so a quantized vector is never widened into a full fp32 copy.
+class InputVector {
+public:
+    InputVector(const span<float> values);
+    InputVector(const span<u16> values, const HalfFormat format);
+    InputVector(const span<i8> values, const float quant_scale);
+
+    u64 size() const {
+        return size_;
+    }
+
+    // Writes elements [offset, offset + count) to dst as fp32.
+    void copyTo(const u64 offset, const u64 count, float *dst) const;
+
+    // Raw input bytes and a tag for their format (and dequantization scale); together they identify the input.
+    const u8 *bytes() const {
+        return static_cast<const u8 *>(data_);
+    }
+    u64 byteSize() const;
+    u64 formatTag() const;
+
+private:
+    enum class Kind : u8 { FLOAT, HALF, INT8 };
+
+    const void *data_;
+    u64 size_;
+    Kind kind_;
+    HalfFormat format_ = HalfFormat::FP16;
+    float quant_scale_ = 1.0f;
+};
+
+} // namespace utils
+} // namespace detail
+} // namespace evi
@@ -43,6 +43,20 @@ bool syncVarKeyToDebSwkKey(const detail::Context &context, const detail::Variadi
 deb::Ciphertext convertPointerToDebCipher(const detail::Context &context, detail::u64 *a_q, detail::u64 *b_q,
                                           detail::u64 *a_p = nullptr, detail::u64 *b_p = nullptr, bool is_ntt = true);
 
+// A deb ciphertext built once for a given level whose polynomials are re-pointed at evi memory by bind(), so
+// decrypting many blocks does not construct a deb::Ciphertext per block.
+class DebCipherView {
+public:
+    DebCipherView(const detail::Context &context, const int level);
+
+    deb::Ciphertext &bind(detail::u64 *a_q, detail::u64 *b_q, detail::u64 *a_p = nullptr, detail::u64 *b_p = nullptr,
+                          bool is_ntt = true);
+
+private:
+    deb::Ciphertext cipher_;
+    int level_;
+};
+
 deb::Ciphertext convertSingleCipherToDebCipher(const detail::Context &context,
                                                detail::SingleBlock<DataType::CIPHER> &cipher, bool is_ntt = true);
 
@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (C) 2025, CryptoLab, Inc.                                       //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//     http://www.apache.org/licenses/LICENSE-2.0                             //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include "EVI/impl/Type.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace evi {
+namespace detail {
+
+/**
+ * Fixed-size pool of worker threads used to spread independent per-ciphertext work across cores.
+ * The calling thread takes part in every parallelFor, so a pool of N threads runs N - 1 workers.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(const u32 num_threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    u32 getNumThreads() const {
+        return static_cast<u32>(workers_.size()) + 1;
+    }
+
+    // Runs fn(i) for every i in [0, n) and returns once all calls have finished. At most max_threads threads
+    // (0: the whole pool) work on the range; the first exception thrown by fn is rethrown on the caller.
+    // Calls made from inside a pool task run sequentially on that task's thread.
+    void parallelFor(const u64 n, const std::function<void(u64)> &fn, const u32 max_threads = 0);
+
+    // Runs fn on a pool thread and returns a future that completes (or rethrows) with it. Without worker threads,
+    // or when called from inside a pool task, fn runs on the calling thread before submit returns.
+    std::future<void> submit(std::function<void()> fn);
+
+    // Process-wide pool sized to the hardware concurrency.
+    static ThreadPool &global();
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+};
+
+} // namespace detail
+} // namespace evi
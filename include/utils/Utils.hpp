@@ -24,6 +24,7 @@
 #include <filesystem>
 #include <fstream>
 #include <functional>
+#include <limits>
 #include <map>
 #include <optional>
 #include <sstream>
@@ -41,9 +42,48 @@ namespace fs = std::filesystem;
 
 void serializeQueryTo(const Query &query, std::ostream &os);
 Query deserializeQueryFrom(std::istream &is);
+// Exact number of bytes serializeQueryTo writes.
+u64 getQuerySerializedSize(const Query &query);
 
 void serializeResultTo(const SearchResult &res, std::ostream &os);
 SearchResult deserializeResultFrom(std::istream &is);
+// Exact number of bytes serializeResultTo writes.
+u64 getResultSerializedSize(const SearchResult &res);
+
+// Chunked result layout (tag 1): the tag and total item count shared with tag 0, a header, then groups of
+// ctxts_per_chunk ciphertexts whose polynomials are stored together, so a reader can decrypt each group as soon as
+// it has arrived. The same header also describes a planar (tag 0) result, with ctxts_per_chunk left at 0.
+struct ResultChunkHeader {
+    int level;
+    u64 n;
+    u64 dim;
+    u64 degree;
+    u64 num_ctxt;
+    u64 ctxts_per_chunk;
+};
+constexpr u8 RESULT_TAG_CHUNKED = 1;
+// Largest ciphertext count a serialized result may declare, as result polynomials are sized by an int.
+constexpr u64 MAX_RESULT_CTXTS = std::numeric_limits<int>::max() / DEGREE;
+void serializeResultChunkedTo(const SearchResult &res, std::ostream &os, const u64 ctxts_per_chunk);
+// The readers below expect the tag and the total item count to have been consumed already.
+ResultChunkHeader readResultChunkHeader(std::istream &is);
+// Resizes chunk to num_ctxt ciphertexts and fills it with the next group from is.
+void readResultChunk(std::istream &is, IData &chunk, const u64 num_ctxt);
+// Planar result layout (tag 0), as written by serializeResultTo: the Matrix header, then the a_q, b_q (and a_p, b_p)
+// polynomials of all ciphertexts, one plane after the other.
+ResultChunkHeader readResultPlanarHeader(std::istream &is);
+// Resizes chunk to num_ctxt ciphertexts and fills it with ciphertexts [first, first + num_ctxt) of a planar result
+// whose planes start at base. is must be seekable.
+void readPlanarResultChunk(std::istream &is, const std::streampos base, const ResultChunkHeader &header, IData &chunk,
+                           const u64 first, const u64 num_ctxt);
+
+// Sharded layout: the shard count, then each shard's item offset followed by the shard in the result layout.
+void serializeShardedResultTo(const ShardedSearchResult &res, std::ostream &os);
+ShardedSearchResult deserializeShardedResultFrom(std::istream &is);
+// Number of real items in a result: its total item count, bounded by what its ciphertexts can hold.
+u64 getResultItemCount(const SearchResult &res);
+// Throws unless every shard has an item offset and the shards' item ranges tile [0, total item count) exactly.
+void validateShardedResult(const ShardedSearchResult &res);
 
 std::string encodeToBase64(const std::vector<uint8_t> &data);
 std::string encodeToBase64(const std::string &str);
@@ -17,6 +17,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 // pybind/bind_decryptor.cpp
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
@@ -113,6 +114,25 @@ void bind_decryptor(py::module_ &m) {
             },
             py::arg("query"), py::arg("key_blob"), py::arg("scale") = py::none())
 
+        .def(
+            "decrypted_size", [](const Decryptor &self, const SearchResult &item) { return self.getDecryptSize(item); },
+            py::arg("search_result"))
+
+        .def(
+            "decrypt_into",
+            [](Decryptor &self, const SearchResult &item, const SecretKey &key, py::array out, bool is_score,
+               std::optional<double> scale) {
+                // Written in place, so a converted copy of the caller's array is never acceptable.
+                if (!out.dtype().equal(py::dtype::of<float>()) || !(out.flags() & py::array::c_style) ||
+                    !out.writeable()) {
+                    throw py::type_error("out must be a writeable, C-contiguous float32 array");
+                }
+                return self.decryptTo(item, key, is_score, static_cast<float *>(out.mutable_data()),
+                                      static_cast<size_t>(out.size()), scale);
+            },
+            py::arg("search_result"), py::arg("secret_key"), py::arg("out"), py::arg("is_score") = true,
+            py::arg("scale") = py::none())
+
         .def(
             "decrypt",
             [](Decryptor &self, int idx, const Query &ctxt, const SecretKey &key, std::optional<double> scale) {
@@ -120,6 +140,14 @@ void bind_decryptor(py::module_ &m) {
             },
             py::arg("index"), py::arg("query"), py::arg("secret_key"), py::arg("scale") = py::none())
 
+        .def(
+            "decrypt_items",
+            [](Decryptor &self, const Query &ctxt, const SecretKey &key, std::optional<std::vector<uint64_t>> indices,
+               std::optional<double> scale) {
+                return indices ? self.decryptItems(ctxt, key, *indices, scale) : self.decryptItems(ctxt, key, scale);
+            },
+            py::arg("query"), py::arg("secret_key"), py::arg("indices") = py::none(), py::arg("scale") = py::none())
+
         .def("__repr__", [](const Decryptor &) {
             return std::string("<evi.Decryptor>");
         });
@@ -17,6 +17,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 // pybind/bind_encryptor.cpp
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
@@ -62,6 +63,23 @@ void bind_encryptor(py::module_ &m) {
             },
             py::arg("data"), py::arg("type"), py::arg("level") = 0, py::arg("scale") = py::none())
 
+        .def(
+            "encode_half",
+            [](Encryptor &self, py::array_t<uint16_t, py::array::c_style | py::array::forcecast> data,
+               HalfFormat format, EncodeType type, int level, std::optional<float> scale) {
+                return self.encode(data.data(), data.size(), format, type, level, scale);
+            },
+            py::arg("data"), py::arg("format"), py::arg("type"), py::arg("level") = 0, py::arg("scale") = py::none())
+
+        .def(
+            "encode_int8",
+            [](Encryptor &self, py::array_t<int8_t, py::array::c_style | py::array::forcecast> data,
+               float quant_scale, EncodeType type, int level, std::optional<float> scale) {
+                return self.encode(data.data(), data.size(), quant_scale, type, level, scale);
+            },
+            py::arg("data"), py::arg("quant_scale"), py::arg("type"), py::arg("level") = 0,
+            py::arg("scale") = py::none())
+
         .def(
             "encode_bulk",
             [](Encryptor &self, const std::vector<std::vector<float>> &msg, const EncodeType type, const int level,
@@ -87,6 +105,24 @@ void bind_encryptor(py::module_ &m) {
             },
             py::arg("data"), py::arg("keypack"), py::arg("type"), py::arg("level") = 0, py::arg("scale") = py::none())
 
+        .def(
+            "encrypt_half",
+            [](Encryptor &self, py::array_t<uint16_t, py::array::c_style | py::array::forcecast> data,
+               HalfFormat format, const KeyPack &keypack, EncodeType type, int level, std::optional<float> scale) {
+                return self.encrypt(data.data(), data.size(), format, keypack, type, level, scale);
+            },
+            py::arg("data"), py::arg("format"), py::arg("keypack"), py::arg("type"), py::arg("level") = 0,
+            py::arg("scale") = py::none())
+
+        .def(
+            "encrypt_int8",
+            [](Encryptor &self, py::array_t<int8_t, py::array::c_style | py::array::forcecast> data,
+               float quant_scale, const KeyPack &keypack, EncodeType type, int level, std::optional<float> scale) {
+                return self.encrypt(data.data(), data.size(), quant_scale, keypack, type, level, scale);
+            },
+            py::arg("data"), py::arg("quant_scale"), py::arg("keypack"), py::arg("type"), py::arg("level") = 0,
+            py::arg("scale") = py::none())
+
         .def(
             "encrypt_with_key_stream",
             [](Encryptor &self, const std::vector<float> &data, const py::object &key_blob, EncodeType type, int level,
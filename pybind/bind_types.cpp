@@ -26,7 +26,6 @@
 #include <pybind11/stl.h>
 
 #include <cstring>
-#include <sstream>
 
 namespace py = pybind11;
 using namespace evi;
@@ -90,6 +89,11 @@ void bind_types(py::module_ &m) {
         .value("QUERY", EncodeType::QUERY)
         .export_values();
 
+    py::enum_<HalfFormat>(m, "HalfFormat", py::arithmetic())
+        .value("FP16", HalfFormat::FP16)
+        .value("BF16", HalfFormat::BF16)
+        .export_values();
+
     py::class_<evi::SealInfo>(m, "SealInfo")
         .def(py::init<evi::SealMode>(), py::arg("mode"))
         .def(py::init([](evi::SealMode mode, const std::vector<uint8_t> &aes_key) {
@@ -106,15 +110,14 @@ void bind_types(py::module_ &m) {
         .def("getInnerItemCount", &Query::getInnerItemCount)
         .def_static("serializeTo",
                     [](const Query &q) {
-                        std::ostringstream os(std::ios::binary);
-                        Query::serializeTo(q, os);
-                        const std::string &s = os.str();
-                        return py::bytes(s.data(), s.size());
+                        // serialize straight into the bytes object's storage
+                        const size_t size = Query::getSerializedSize(q);
+                        py::bytes out(nullptr, size);
+                        Query::serializeToBuffer(q, PyBytes_AS_STRING(out.ptr()), size);
+                        return out;
                     })
         .def_static("deserializeFrom", [](py::bytes b) {
-            std::string s = b;
-            std::istringstream is(s, std::ios::binary);
-            return Query::deserializeFrom(is);
+            return Query::deserializeFromBuffer(PyBytes_AS_STRING(b.ptr()), PyBytes_GET_SIZE(b.ptr()));
         });
 
     py::class_<Message>(m, "Message", py::buffer_protocol())
@@ -174,18 +177,16 @@ void bind_types(py::module_ &m) {
         .def_static(
             "serializeTo",
             [](const evi::SearchResult &res) {
-                std::ostringstream os(std::ios::binary);
-                evi::SearchResult::serializeTo(res, os);
-                const std::string &s = os.str();
-                return py::bytes(s.data(), s.size());
+                const size_t size = evi::SearchResult::getSerializedSize(res);
+                py::bytes out(nullptr, size);
+                evi::SearchResult::serializeToBuffer(res, PyBytes_AS_STRING(out.ptr()), size);
+                return out;
             },
             py::arg("res"))
         .def_static(
             "deserializeFrom",
             [](py::bytes b) {
-                std::string s = b;
-                std::istringstream is(s, std::ios::binary);
-                return evi::SearchResult::deserializeFrom(is);
+                return evi::SearchResult::deserializeFromBuffer(PyBytes_AS_STRING(b.ptr()), PyBytes_GET_SIZE(b.ptr()));
             },
             py::arg("data"))
         .def("__repr__", [](const evi::SearchResult &) {
@@ -94,6 +94,26 @@ def test_encryptor_with_keypath(ctx, key_dir, dim):
     except Exception as ex:
         pytest.fail(f"Encryptor(ctx, key_path) flow failed: {type(ex).__name__}: {ex}")
 
+def test_encryptor_quantized_inputs(ctx, key_dir, dim):
+    import numpy as np
+
+    try:
+        kp = evi.KeyPack(ctx)
+        kp.load_enc_key_file(key_dir + "/EncKey.bin")
+        enc = evi.Encryptor(ctx)
+
+        values = np.linspace(-1.0, 1.0, dim, dtype=np.float32)
+        bf16 = (values.view(np.uint32) >> 16).astype(np.uint16)
+        fp16 = values.astype(np.float16).view(np.uint16)
+        int8 = np.round(values * 127).astype(np.int8)
+
+        assert enc.encode_half(bf16, evi.HalfFormat.BF16, evi.EncodeType.ITEM) is not None
+        assert enc.encode_int8(int8, 1.0 / 127, evi.EncodeType.QUERY) is not None
+        assert isinstance(enc.encrypt_half(fp16, evi.HalfFormat.FP16, kp, evi.EncodeType.ITEM), evi.Query)
+        assert isinstance(enc.encrypt_int8(int8, 1.0 / 127, kp, evi.EncodeType.ITEM), evi.Query)
+    except Exception as ex:
+        pytest.fail(f"Encryptor quantized input flow failed: {type(ex).__name__}: {ex}")
+
 def test_encryptor_with_pcmm(ctx_pcmm, key_dir_pcmm, dim):
     try:
         enc = evi.Encryptor(ctx_pcmm)
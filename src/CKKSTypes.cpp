@@ -18,9 +18,11 @@
 
 #include "EVI/impl/CKKSTypes.hpp"
 #include "EVI/impl/Const.hpp"
+#include "utils/BufferStream.hpp"
 #include "utils/Exceptions.hpp"
 #include <cassert>
 #include <cstring>
+#include <limits>
 
 namespace evi {
 
@@ -29,26 +31,7 @@ namespace detail {
 
 template <DataType T>
 SingleBlock<T>::SingleBlock(const int level) : dtype_(T) {
-    level_ = level;
-    if constexpr (T == DataType::CIPHER) {
-        poly a_q, b_q;
-        a_q_ = a_q;
-        b_q_ = b_q;
-        if (level) {
-            poly a_p, b_p;
-            a_q_ = a_p;
-            b_q_ = b_p;
-        }
-    } else {
-        dtype_ = DataType::PLAIN;
-        level_ = level;
-        poly q;
-        b_q_ = q;
-        if (level) {
-            poly p;
-            b_p_ = p;
-        }
-    }
+    allocate(level);
 }
 
 template <DataType T>
@@ -57,7 +40,7 @@ SingleBlock<T>::SingleBlock(const poly &b_q) : dtype_(T) {
         throw evi::InvalidAccessError("Cannot create Ciphertext with a polynomial");
     } else {
         level_ = 0;
-        b_q_ = b_q;
+        polys_.push_back(b_q);
     }
 }
 
@@ -65,21 +48,28 @@ template <DataType T>
 SingleBlock<T>::SingleBlock(const poly &a_q, const poly &b_q) : dtype_(T) {
     if constexpr (T == DataType::CIPHER) {
         level_ = 0;
-        a_q_ = (a_q);
-        b_q_ = (b_q);
+        polys_.reserve(getPolyCount(level_));
+        polys_.push_back(b_q);
+        polys_.push_back(a_q);
     } else {
         level_ = 1;
-        b_q_ = (a_q);
-        b_p_ = (b_q);
+        polys_.reserve(getPolyCount(level_));
+        polys_.push_back(a_q);
+        polys_.push_back(b_q);
     }
 }
 
 template <DataType T>
 SingleBlock<T>::SingleBlock(const poly &a_q, const poly &a_p, const poly &b_q, const poly &b_p)
-    : dtype_(T), level_(1), a_q_((a_q)), a_p_((a_p)), b_q_((b_q)), b_p_((b_p)) {
+    : dtype_(T), level_(1) {
     if constexpr (T == DataType::PLAIN) {
         throw evi::InvalidAccessError("Cannot create plaintext with more than 2 polynomials");
     }
+    polys_.reserve(getPolyCount(level_));
+    polys_.push_back(b_q);
+    polys_.push_back(a_q);
+    polys_.push_back(b_p);
+    polys_.push_back(a_p);
 }
 
 template <DataType T>
@@ -92,6 +82,43 @@ SingleBlock<T>::SingleBlock(std::vector<u8> &buf) : dtype_(T) {
     deserializeFrom(buf);
 }
 
+template <DataType T>
+void SingleBlock<T>::allocate(const int level) {
+    level_ = level;
+    polys_.resize(getPolyCount(level_));
+    polys_.shrink_to_fit();
+}
+
+template <DataType T>
+int SingleBlock<T>::getPolyIndex(const int pos, const int level) const {
+    if constexpr (T == DataType::CIPHER) {
+        if (pos != 0 && pos != 1) {
+            throw evi::InvalidAccessError("Cannot access to poly other than 0 or 1");
+        }
+        if (level && !level_) {
+            throw evi::InvalidAccessError("Cannot access to poly other than 1");
+        }
+        return (level ? 2 : 0) + pos;
+    } else {
+        if (pos || (level && !level_)) {
+            throw evi::InvalidAccessError("--");
+        }
+        return level ? 1 : 0;
+    }
+}
+
+template <DataType T>
+u64 SingleBlock<T>::getSerializedSize() const {
+    const u64 header = sizeof(int) + 5 * sizeof(u64) + sizeof(std::underlying_type_t<evi::EncodeType>);
+    const u64 polys = (T == DataType::CIPHER ? 2 : 1) * (level_ ? 2 : 1);
+    return header + polys * U64_DEGREE;
+}
+
+template <DataType T>
+std::shared_ptr<IQuery> SingleBlock<T>::clone() const {
+    return std::make_shared<SingleBlock<T>>(*this);
+}
+
 template <DataType T>
 void SingleBlock<T>::serializeTo(std::ostream &stream) const {
     stream.write(reinterpret_cast<const char *>(&level_), sizeof(int));
@@ -103,23 +130,24 @@ void SingleBlock<T>::serializeTo(std::ostream &stream) const {
     auto enc_type = static_cast<std::underlying_type_t<evi::EncodeType>>(encode_type);
     stream.write(reinterpret_cast<const char *>(&enc_type), sizeof(enc_type));
     if constexpr (T == DataType::CIPHER) {
-        stream.write(reinterpret_cast<const char *>(a_q_.data()), U64_DEGREE);
-        stream.write(reinterpret_cast<const char *>(b_q_.data()), U64_DEGREE);
+        stream.write(reinterpret_cast<const char *>(getPolyData(1, 0)), U64_DEGREE);
+        stream.write(reinterpret_cast<const char *>(getPolyData(0, 0)), U64_DEGREE);
         if (level_) {
-            stream.write(reinterpret_cast<const char *>(a_p_.data()), U64_DEGREE);
-            stream.write(reinterpret_cast<const char *>(b_p_.data()), U64_DEGREE);
+            stream.write(reinterpret_cast<const char *>(getPolyData(1, 1)), U64_DEGREE);
+            stream.write(reinterpret_cast<const char *>(getPolyData(0, 1)), U64_DEGREE);
         }
     } else {
-        stream.write(reinterpret_cast<const char *>(b_q_.data()), U64_DEGREE);
+        stream.write(reinterpret_cast<const char *>(getPolyData(0, 0)), U64_DEGREE);
         if (level_) {
-            stream.write(reinterpret_cast<const char *>(b_p_.data()), U64_DEGREE);
+            stream.write(reinterpret_cast<const char *>(getPolyData(0, 1)), U64_DEGREE);
         }
     }
 }
 
 template <DataType T>
 void SingleBlock<T>::deserializeFrom(std::istream &stream) {
-    stream.read(reinterpret_cast<char *>(&level_), sizeof(int));
+    int level = 0;
+    stream.read(reinterpret_cast<char *>(&level), sizeof(int));
     stream.read(reinterpret_cast<char *>(&n), sizeof(u64));
     stream.read(reinterpret_cast<char *>(&dim), sizeof(u64));
     stream.read(reinterpret_cast<char *>(&degree), sizeof(u64));
@@ -128,193 +156,72 @@ void SingleBlock<T>::deserializeFrom(std::istream &stream) {
     std::underlying_type_t<evi::EncodeType> enc_type_raw = 0;
     stream.read(reinterpret_cast<char *>(&enc_type_raw), sizeof(enc_type_raw));
     encode_type = static_cast<evi::EncodeType>(enc_type_raw);
+    allocate(level);
     if constexpr (T == DataType::CIPHER) {
-        stream.read(reinterpret_cast<char *>(a_q_.data()), U64_DEGREE);
-        stream.read(reinterpret_cast<char *>(b_q_.data()), U64_DEGREE);
+        stream.read(reinterpret_cast<char *>(getPolyData(1, 0)), U64_DEGREE);
+        stream.read(reinterpret_cast<char *>(getPolyData(0, 0)), U64_DEGREE);
         if (level_) {
-            stream.read(reinterpret_cast<char *>(a_p_.data()), U64_DEGREE);
-            stream.read(reinterpret_cast<char *>(b_p_.data()), U64_DEGREE);
+            stream.read(reinterpret_cast<char *>(getPolyData(1, 1)), U64_DEGREE);
+            stream.read(reinterpret_cast<char *>(getPolyData(0, 1)), U64_DEGREE);
         }
     } else {
-        stream.read(reinterpret_cast<char *>(b_q_.data()), U64_DEGREE);
+        stream.read(reinterpret_cast<char *>(getPolyData(0, 0)), U64_DEGREE);
         if (level_) {
-            stream.read(reinterpret_cast<char *>(b_p_.data()), U64_DEGREE);
+            stream.read(reinterpret_cast<char *>(getPolyData(0, 1)), U64_DEGREE);
         }
     }
 }
 
 template <DataType T>
 void SingleBlock<T>::serializeTo(std::vector<u8> &buf) const {
-    std::stringstream ss;
-    serializeTo(ss);
-    std::string str = ss.str();
-    buf.insert(buf.end(), str.begin(), str.end());
+    utils::serializeAppend(buf, getSerializedSize(), [&](std::ostream &os) { serializeTo(os); });
 }
 
 template <DataType T>
 void SingleBlock<T>::deserializeFrom(const std::vector<u8> &buf) {
-    std::stringstream ss;
-    ss.write(reinterpret_cast<const char *>(buf.data()), buf.size());
-    deserializeFrom(ss);
+    utils::deserializeFromBuffer(reinterpret_cast<const char *>(buf.data()), buf.size(),
+                                 [&](std::istream &is) { deserializeFrom(is); });
 }
 
 template <DataType T>
 poly &SingleBlock<T>::getPoly(const int pos, const int level, std::optional<const int> index) {
-    if constexpr (T == DataType::CIPHER) {
-        if (level) {
-            if (!level_) {
-                throw evi::InvalidAccessError("Cannot access to poly other than 1");
-            }
-            if (pos == 1) {
-                return a_p_;
-            } else if (!pos) {
-                return b_p_;
-            } else {
-                throw evi::InvalidAccessError("Cannot access to poly other than 0 or 1");
-            }
-        } else {
-            if (pos == 1) {
-                return a_q_;
-            } else if (!pos) {
-                return b_q_;
-            } else {
-                throw evi::InvalidAccessError("Cannot access to poly other than 0 or 1");
-            }
-        }
-    } else {
-        if (!pos) {
-            if (!level) {
-                return b_q_;
-            } else {
-                if (!level_) {
-                    throw evi::InvalidAccessError("--");
-                }
-                return b_p_;
-            }
-        } else {
-            throw evi::InvalidAccessError("--");
-        }
-    }
+    return polys_[getPolyIndex(pos, level)];
 }
+
 template <DataType T>
 const poly &SingleBlock<T>::getPoly(const int pos, const int level, std::optional<const int> index) const {
-    if constexpr (T == DataType::CIPHER) {
-        if (level) {
-            if (!level_) {
-                throw evi::InvalidAccessError("Cannot access to poly other than 1");
-            }
-            if (pos == 1) {
-                return a_p_;
-            } else if (!pos) {
-                return b_p_;
-            } else {
-                throw evi::InvalidAccessError("Cannot access to poly other than 0 or 1");
-            }
-        } else {
-            if (pos == 1) {
-                return a_q_;
-            } else if (!pos) {
-                return b_q_;
-            } else {
-                throw evi::InvalidAccessError("Cannot access to poly other than 0 or 1");
-            }
-        }
-    } else {
-        if (!pos) {
-            if (!level) {
-                return b_q_;
-            } else {
-                if (!level_) {
-                    throw evi::InvalidAccessError("--");
-                }
-                return b_p_;
-            }
-        } else {
-            throw evi::InvalidAccessError("--");
-        }
-    }
+    return polys_[getPolyIndex(pos, level)];
 }
 
 template <DataType T>
 polydata SingleBlock<T>::getPolyData(const int pos, const int level, std::optional<const int> index) {
-    if constexpr (T == DataType::CIPHER) {
-        if (level) {
-            if (!level_) {
-                throw evi::InvalidAccessError("Cannot access to poly other than 1");
-            }
-            if (pos == 1) {
-                return a_p_.data();
-            } else if (!pos) {
-                return b_p_.data();
-            } else {
-                throw evi::InvalidAccessError("Cannot access to poly other than 0 or 1");
-            }
-        } else {
-            if (pos == 1) {
-                return a_q_.data();
-            } else if (!pos) {
-                return b_q_.data();
-            } else {
-                throw evi::InvalidAccessError("Cannot access to poly other than 0 or 1");
-            }
-        }
-    } else {
-        if (!pos) {
-            if (!level) {
-                return b_q_.data();
-            } else {
-                if (!level_) {
-                    throw evi::InvalidAccessError("--");
-                }
-                return b_p_.data();
-            }
-        } else {
-            throw evi::InvalidAccessError("--");
-        }
-    }
+    return polys_[getPolyIndex(pos, level)].data();
 }
 
 template <DataType T>
 polydata SingleBlock<T>::getPolyData(const int pos, const int level, std::optional<const int> index) const {
-    if constexpr (T == DataType::CIPHER) {
-        if (level) {
-            if (!level_) {
-                throw evi::InvalidAccessError("Cannot access to poly other than 1");
-            }
-            if (pos == 1) {
-                return const_cast<polydata>(a_p_.data());
-            } else if (!pos) {
-                return const_cast<polydata>(b_p_.data());
-            } else {
-                throw evi::InvalidAccessError("Cannot access to poly other than 0 or 1");
-            }
-        } else {
-            if (pos == 1) {
-                return const_cast<polydata>(a_q_.data());
-            } else if (!pos) {
-                return const_cast<polydata>(b_q_.data());
-            } else {
-                throw evi::InvalidAccessError("Cannot access to poly other than 0 or 1");
-            }
-        }
-    } else {
-        if (!pos) {
-            if (!level) {
-                return const_cast<polydata>(b_q_.data());
-            } else {
-                if (!level_) {
-                    throw evi::InvalidAccessError("--");
-                }
-                return const_cast<polydata>(b_p_.data());
-            }
-        } else {
-            throw evi::InvalidAccessError("--");
+    return const_cast<polydata>(polys_[getPolyIndex(pos, level)].data());
+}
+
+template <DataType T>
+SerializedSingleQuery<T>::SerializedSingleQuery(polyvec128 &ptxt) : level_(0) {
+    if constexpr (T != DataType::PLAIN) {
+        throw InvalidAccessError("Check");
+    }
+    dtype_ = DataType::SERIALIZED_PLAIN;
+    if (ptxt.size() != DEGREE) {
+        throw InvalidInputError("Serialized query must hold exactly DEGREE coefficients");
+    }
+    for (u64 i = 0; i < DEGREE; ++i) {
+        if (ptxt[i] >> 64) {
+            throw InvalidInputError("Serialized query coefficients must be reduced mod Q");
         }
+        lo_[i] = static_cast<u64>(ptxt[i]);
     }
 }
 
 template <DataType T>
-SerializedSingleQuery<T>::SerializedSingleQuery(polyvec128 &ptxt) : level_(0), ptxt_(std::move(ptxt)) {
+SerializedSingleQuery<T>::SerializedSingleQuery(const poly &ptxt_q) : level_(0), lo_(ptxt_q) {
     if constexpr (T != DataType::PLAIN) {
         throw InvalidAccessError("Check");
     }
@@ -322,21 +229,137 @@ SerializedSingleQuery<T>::SerializedSingleQuery(polyvec128 &ptxt) : level_(0), p
 }
 
 template <DataType T>
-polyvec128 &SerializedSingleQuery<T>::getPoly() {
+SerializedSingleQuery<T>::SerializedSingleQuery(std::istream &stream) : level_(0) {
     if constexpr (T != DataType::PLAIN) {
         throw InvalidAccessError("Check");
     }
+    dtype_ = DataType::SERIALIZED_PLAIN;
+    deserializeFrom(stream);
+}
+
+template <DataType T>
+SerializedSingleQuery<T>::SerializedSingleQuery(const SerializedSingleQuery &other)
+    : IQuery(other), dtype_(other.dtype_), level_(other.level_), lo_(other.lo_) {}
 
-    return ptxt_;
+template <DataType T>
+SerializedSingleQuery<T> &SerializedSingleQuery<T>::operator=(const SerializedSingleQuery &other) {
+    if (this != &other) {
+        IQuery::operator=(other);
+        dtype_ = other.dtype_;
+        level_ = other.level_;
+        lo_ = other.lo_;
+        // the once_flag cannot be reset, so a copy that was already widened is refreshed in place
+        if (!wide_.empty()) {
+            widen();
+        }
+    }
+    return *this;
 }
 
 template <DataType T>
-u128 *SerializedSingleQuery<T>::getPolyData() {
+void SerializedSingleQuery<T>::checkPlaneAccess(const int pos, const int level) const {
+    if (pos || level) {
+        throw InvalidAccessError("Serialized query only holds a single level-0 polynomial");
+    }
+}
+
+template <DataType T>
+poly &SerializedSingleQuery<T>::getPoly(const int pos, const int level, std::optional<const int> index) {
+    checkPlaneAccess(pos, level);
+    return lo_;
+}
+
+template <DataType T>
+const poly &SerializedSingleQuery<T>::getPoly(const int pos, const int level, std::optional<const int> index) const {
+    checkPlaneAccess(pos, level);
+    return lo_;
+}
+
+template <DataType T>
+polydata SerializedSingleQuery<T>::getPolyData(const int pos, const int level, std::optional<const int> index) {
+    checkPlaneAccess(pos, level);
+    return lo_.data();
+}
+
+template <DataType T>
+polydata SerializedSingleQuery<T>::getPolyData(const int pos, const int level,
+                                               std::optional<const int> index) const {
+    checkPlaneAccess(pos, level);
+    return const_cast<polydata>(lo_.data());
+}
+
+template <DataType T>
+void SerializedSingleQuery<T>::widen() {
+    wide_.resize(DEGREE);
+    for (u64 i = 0; i < DEGREE; ++i) {
+        wide_[i] = static_cast<u128>(lo_[i]);
+    }
+}
+
+template <DataType T>
+polyvec128 &SerializedSingleQuery<T>::getPoly() {
     if constexpr (T != DataType::PLAIN) {
         throw InvalidAccessError("Check");
     }
+    std::call_once(wide_once_, [this] { widen(); });
+    return wide_;
+}
+
+template <DataType T>
+u128 *SerializedSingleQuery<T>::getPolyData() {
+    return getPoly().data();
+}
 
-    return ptxt_.data();
+template <DataType T>
+u64 SerializedSingleQuery<T>::getSerializedSize() const {
+    return sizeof(int) + 5 * sizeof(u64) + sizeof(std::underlying_type_t<evi::EncodeType>) + U64_DEGREE;
+}
+
+template <DataType T>
+std::shared_ptr<IQuery> SerializedSingleQuery<T>::clone() const {
+    return std::make_shared<SerializedSingleQuery<T>>(*this);
+}
+
+template <DataType T>
+void SerializedSingleQuery<T>::serializeTo(std::ostream &stream) const {
+    stream.write(reinterpret_cast<const char *>(&level_), sizeof(int));
+    stream.write(reinterpret_cast<const char *>(&n), sizeof(u64));
+    stream.write(reinterpret_cast<const char *>(&dim), sizeof(u64));
+    stream.write(reinterpret_cast<const char *>(&degree), sizeof(u64));
+    stream.write(reinterpret_cast<const char *>(&show_dim), sizeof(u64));
+    stream.write(reinterpret_cast<const char *>(&scale_bit), sizeof(u64));
+    auto enc_type = static_cast<std::underlying_type_t<evi::EncodeType>>(encode_type);
+    stream.write(reinterpret_cast<const char *>(&enc_type), sizeof(enc_type));
+    stream.write(reinterpret_cast<const char *>(lo_.data()), U64_DEGREE);
+}
+
+template <DataType T>
+void SerializedSingleQuery<T>::deserializeFrom(std::istream &stream) {
+    stream.read(reinterpret_cast<char *>(&level_), sizeof(int));
+    stream.read(reinterpret_cast<char *>(&n), sizeof(u64));
+    stream.read(reinterpret_cast<char *>(&dim), sizeof(u64));
+    stream.read(reinterpret_cast<char *>(&degree), sizeof(u64));
+    stream.read(reinterpret_cast<char *>(&show_dim), sizeof(u64));
+    stream.read(reinterpret_cast<char *>(&scale_bit), sizeof(u64));
+    std::underlying_type_t<evi::EncodeType> enc_type_raw = 0;
+    stream.read(reinterpret_cast<char *>(&enc_type_raw), sizeof(enc_type_raw));
+    encode_type = static_cast<evi::EncodeType>(enc_type_raw);
+    stream.read(reinterpret_cast<char *>(lo_.data()), U64_DEGREE);
+    // like any mutation this needs exclusive access; a copy that was already widened is refreshed in place
+    if (!wide_.empty()) {
+        widen();
+    }
+}
+
+template <DataType T>
+void SerializedSingleQuery<T>::serializeTo(std::vector<u8> &buf) const {
+    utils::serializeAppend(buf, getSerializedSize(), [&](std::ostream &os) { serializeTo(os); });
+}
+
+template <DataType T>
+void SerializedSingleQuery<T>::deserializeFrom(const std::vector<u8> &buf) {
+    utils::deserializeFromBuffer(reinterpret_cast<const char *>(buf.data()), buf.size(),
+                                 [&](std::istream &is) { deserializeFrom(is); });
 }
 
 // ======================= Matrix<T> ===============================================
@@ -397,33 +420,39 @@ Matrix<T>::Matrix(polyvec a_q, polyvec a_p, polyvec b_q, polyvec b_p)
     }
 }
 
+template <DataType T>
+u64 Matrix<T>::getSerializedSize() const {
+    // a default-constructed Matrix has no degree yet and serializes as its header alone
+    const u64 num_ctxt = degree ? (n + degree - 1) / degree : 0;
+    const u64 polys = (T == DataType::CIPHER ? 2 : 1) * (level_ ? 2 : 1);
+    return sizeof(int) + 3 * sizeof(u64) + polys * num_ctxt * U64_DEGREE;
+}
+
 template <DataType T>
 void Matrix<T>::serializeTo(std::ostream &stream) const {
     stream.write(reinterpret_cast<const char *>(&level_), sizeof(int));
     stream.write(reinterpret_cast<const char *>(&n), sizeof(u64));
     stream.write(reinterpret_cast<const char *>(&dim), sizeof(u64));
     stream.write(reinterpret_cast<const char *>(&degree), sizeof(u64));
+    const u64 plane_bytes = degree ? (n + degree - 1) / degree * U64_DEGREE : 0;
     if constexpr (T == DataType::CIPHER) {
-        stream.write(reinterpret_cast<const char *>(a_q_.data()), (n + degree - 1) / degree * U64_DEGREE);
-        stream.write(reinterpret_cast<const char *>(b_q_.data()), (n + degree - 1) / degree * U64_DEGREE);
+        stream.write(reinterpret_cast<const char *>(a_q_.data()), plane_bytes);
+        stream.write(reinterpret_cast<const char *>(b_q_.data()), plane_bytes);
         if (level_) {
-            stream.write(reinterpret_cast<const char *>(a_p_.data()), (n + degree - 1) / degree * U64_DEGREE);
-            stream.write(reinterpret_cast<const char *>(b_p_.data()), (n + degree - 1) / degree * U64_DEGREE);
+            stream.write(reinterpret_cast<const char *>(a_p_.data()), plane_bytes);
+            stream.write(reinterpret_cast<const char *>(b_p_.data()), plane_bytes);
         }
     } else {
-        stream.write(reinterpret_cast<const char *>(b_q_.data()), (n + degree - 1) / degree * U64_DEGREE);
+        stream.write(reinterpret_cast<const char *>(b_q_.data()), plane_bytes);
         if (level_) {
-            stream.write(reinterpret_cast<const char *>(b_p_.data()), (n + degree - 1) / degree * U64_DEGREE);
+            stream.write(reinterpret_cast<const char *>(b_p_.data()), plane_bytes);
         }
     }
 }
 
 template <DataType T>
 void Matrix<T>::serializeTo(std::vector<u8> &buf) const {
-    std::stringstream ss;
-    serializeTo(ss);
-    std::string str = ss.str();
-    buf.insert(buf.end(), str.begin(), str.end());
+    utils::serializeAppend(buf, getSerializedSize(), [&](std::ostream &os) { serializeTo(os); });
 }
 
 template <DataType T>
@@ -432,7 +461,18 @@ void Matrix<T>::deserializeFrom(std::istream &stream) {
     stream.read(reinterpret_cast<char *>(&n), sizeof(u64));
     stream.read(reinterpret_cast<char *>(&dim), sizeof(u64));
     stream.read(reinterpret_cast<char *>(&degree), sizeof(u64));
-    setSize((n + degree - 1) / degree * U64_DEGREE);
+    // Same rule as utils::readResultPlanarHeader: the payload is laid out in DEGREE-sized polys at level 0 or 1.
+    // setSize takes an int coefficient count, so also reject headers that would overflow it.
+    const u64 max_ctxts = static_cast<u64>(std::numeric_limits<int>::max()) / DEGREE;
+    if (!stream || degree != DEGREE || (level_ != 0 && level_ != 1) || n / DEGREE + (n % DEGREE != 0) > max_ctxts) {
+        throw InvalidInputError("Invalid matrix header");
+    }
+    if (!level_) {
+        // release the P halves left over from a previous level-1 payload
+        polyvec().swap(a_p_);
+        polyvec().swap(b_p_);
+    }
+    setSize((n + degree - 1) / degree * DEGREE);
     if constexpr (T == DataType::CIPHER) {
         stream.read(reinterpret_cast<char *>(a_q_.data()), (n + degree - 1) / degree * U64_DEGREE);
         stream.read(reinterpret_cast<char *>(b_q_.data()), (n + degree - 1) / degree * U64_DEGREE);
@@ -450,9 +490,8 @@ void Matrix<T>::deserializeFrom(std::istream &stream) {
 
 template <DataType T>
 void Matrix<T>::deserializeFrom(const std::vector<u8> &buf) {
-    std::stringstream ss;
-    ss.write(reinterpret_cast<const char *>(buf.data()), buf.size());
-    deserializeFrom(ss);
+    utils::deserializeFromBuffer(reinterpret_cast<const char *>(buf.data()), buf.size(),
+                                 [&](std::istream &is) { deserializeFrom(is); });
 }
 
 template <DataType T>
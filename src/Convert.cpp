@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (C) 2025, CryptoLab, Inc.                                       //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//     http://www.apache.org/licenses/LICENSE-2.0                             //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "utils/Convert.hpp"
+
+#include <cstring>
+
+namespace evi {
+namespace detail {
+namespace utils {
+
+namespace {
+inline float bitsToFloat(const u32 bits) {
+    float f;
+    std::memcpy(&f, &bits, sizeof(float));
+    return f;
+}
+
+inline u32 floatToBits(const float f) {
+    u32 bits;
+    std::memcpy(&bits, &f, sizeof(float));
+    return bits;
+}
+
+// binary16 -> binary32 by moving exponent and mantissa into place and rebiasing with one multiply by 2^112, which
+// also normalizes subnormals. Inputs that were inf/NaN end up >= 2^16 and get their exponent saturated.
+// Relies on subnormal floats not being flushed to zero.
+inline float fp16ToFloat(const u16 h) {
+    constexpr u32 magic = static_cast<u32>(254 - 15) << 23;
+    constexpr u32 was_inf_nan = static_cast<u32>(127 + 16) << 23;
+    u32 bits = floatToBits(bitsToFloat(static_cast<u32>(h & 0x7fff) << 13) * bitsToFloat(magic));
+    bits |= bits >= was_inf_nan ? (255U << 23) : 0U;
+    bits |= static_cast<u32>(h & 0x8000) << 16;
+    return bitsToFloat(bits);
+}
+} // namespace
+
+void convertHalfToFloat(const u16 *src, const u64 size, const HalfFormat format, float *dst) {
+    if (format == HalfFormat::BF16) {
+        for (u64 i = 0; i < size; ++i) {
+            dst[i] = bitsToFloat(static_cast<u32>(src[i]) << 16);
+        }
+    } else {
+        for (u64 i = 0; i < size; ++i) {
+            dst[i] = fp16ToFloat(src[i]);
+        }
+    }
+}
+
+void convertInt8ToFloat(const i8 *src, const u64 size, const float quant_scale, float *dst) {
+    for (u64 i = 0; i < size; ++i) {
+        dst[i] = static_cast<float>(src[i]) * quant_scale;
+    }
+}
+
+InputVector::InputVector(const span<float> values) : data_(values.data()), size_(values.size()), kind_(Kind::FLOAT) {}
+
+InputVector::InputVector(const span<u16> values, const HalfFormat format)
+    : data_(values.data()), size_(values.size()), kind_(Kind::HALF), format_(format) {}
+
+InputVector::InputVector(const span<i8> values, const float quant_scale)
+    : data_(values.data()), size_(values.size()), kind_(Kind::INT8), quant_scale_(quant_scale) {}
+
+void InputVector::copyTo(const u64 offset, const u64 count, float *dst) const {
+    switch (kind_) {
+    case Kind::FLOAT:
+        std::memcpy(dst, static_cast<const float *>(data_) + offset, count * sizeof(float));
+        break;
+    case Kind::HALF:
+        convertHalfToFloat(static_cast<const u16 *>(data_) + offset, count, format_, dst);
+        break;
+    case Kind::INT8:
+        convertInt8ToFloat(static_cast<const i8 *>(data_) + offset, count, quant_scale_, dst);
+        break;
+    }
+}
+
+u64 InputVector::byteSize() const {
+    switch (kind_) {
+    case Kind::HALF:
+        return size_ * sizeof(u16);
+    case Kind::INT8:
+        return size_ * sizeof(i8);
+    default:
+        return size_ * sizeof(float);
+    }
+}
+
+u64 InputVector::formatTag() const {
+    u64 tag = static_cast<u64>(kind_);
+    if (kind_ == Kind::HALF) {
+        tag |= static_cast<u64>(format_) << 8;
+    } else if (kind_ == Kind::INT8) {
+        tag |= static_cast<u64>(floatToBits(quant_scale_)) << 32;
+    }
+    return tag;
+}
+
+} // namespace utils
+} // namespace detail
+} // namespace evi
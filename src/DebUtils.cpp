@@ -168,6 +168,23 @@ deb::Ciphertext convertPointerToDebCipher(const detail::Context &context, detail
     return deb_cipher;
 }
 
+DebCipherView::DebCipherView(const detail::Context &context, const int level)
+    : cipher_(getDebPreset(context), level, 2), level_(level) {}
+
+deb::Ciphertext &DebCipherView::bind(detail::u64 *a_q, detail::u64 *b_q, detail::u64 *a_p, detail::u64 *b_p,
+                                     bool is_ntt) {
+    cipher_[1][0].setData(a_q, detail::DEGREE);
+    cipher_[0][0].setData(b_q, detail::DEGREE);
+    if (level_ == 1) {
+        cipher_[1][1].setData(a_p, detail::DEGREE);
+        cipher_[0][1].setData(b_p, detail::DEGREE);
+    }
+    // decryption may leave the flags changed, so they are reset on every bind
+    cipher_.setEncoding(deb::COEFF);
+    cipher_.setNTT(is_ntt);
+    return cipher_;
+}
+
 } // namespace utils
 } // namespace detail
 } // namespace evi
@@ -32,6 +32,31 @@ Message Decryptor::decrypt(const SearchResult &item, const SecretKey &key, bool
         std::make_shared<detail::Message>((*impl_)->decrypt(*getImpl(item), *getImpl(key), is_score, scale)));
 }
 
+std::vector<Message> Decryptor::decrypt(const std::vector<SearchResult> &items, const SecretKey &key, bool is_score,
+                                        std::optional<double> scale) {
+    std::vector<const detail::SearchResult *> results(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        results[i] = getImpl(items[i]).get();
+    }
+    std::vector<detail::Message> msgs = (*impl_)->decryptBatch(results, *getImpl(key), is_score, scale);
+
+    std::vector<Message> res;
+    res.reserve(msgs.size());
+    for (auto &msg : msgs) {
+        res.emplace_back(std::make_shared<detail::Message>(std::move(msg)));
+    }
+    return res;
+}
+
+size_t Decryptor::getDecryptSize(const SearchResult &item) const {
+    return (*impl_)->getDecryptSize(*getImpl(item));
+}
+
+size_t Decryptor::decryptTo(const SearchResult &item, const SecretKey &seckey, bool is_score, float *out,
+                            size_t capacity, std::optional<double> scale) {
+    return (*impl_)->decryptTo(*getImpl(item), *getImpl(seckey), is_score, span<float>(out, capacity), scale);
+}
+
 Message Decryptor::decrypt(const SearchResult &item, const std::string &key_path, bool is_score,
                            std::optional<double> scale) {
     return Message(std::make_shared<detail::Message>((*impl_)->decrypt(*getImpl(item), key_path, is_score, scale)));
@@ -58,6 +83,70 @@ Message Decryptor::decrypt(int idx, const Query &ctxt, const SecretKey &key, std
     return Message(std::make_shared<detail::Message>((*impl_)->decrypt(idx, *getImpl(ctxt), *getImpl(key), scale)));
 }
 
+std::vector<Message> Decryptor::decryptItems(const Query &ctxt, const SecretKey &key, std::optional<double> scale) {
+    auto items = (*impl_)->decryptItems(*getImpl(ctxt), *getImpl(key), scale);
+    std::vector<Message> res;
+    res.reserve(items.size());
+    for (auto &item : items) {
+        res.emplace_back(std::make_shared<detail::Message>(std::move(item)));
+    }
+    return res;
+}
+
+std::vector<Message> Decryptor::decryptItems(const Query &ctxt, const SecretKey &key,
+                                             const std::vector<uint64_t> &indices, std::optional<double> scale) {
+    auto items = (*impl_)->decryptItems(*getImpl(ctxt), *getImpl(key), indices, scale);
+    std::vector<Message> res;
+    res.reserve(items.size());
+    for (auto &item : items) {
+        res.emplace_back(std::make_shared<detail::Message>(std::move(item)));
+    }
+    return res;
+}
+
+std::vector<std::pair<uint64_t, float>> Decryptor::decryptTopK(const SearchResult &item, const SecretKey &seckey,
+                                                               uint32_t k, std::optional<double> scale) {
+    return (*impl_)->decryptTopK(*getImpl(item), *getImpl(seckey), k, scale);
+}
+
+Message Decryptor::decrypt(const ShardedSearchResult &item, const SecretKey &seckey, std::optional<double> scale) {
+    return Message(
+        std::make_shared<detail::Message>((*impl_)->decryptSharded(*getImpl(item), *getImpl(seckey), scale)));
+}
+
+std::vector<std::pair<uint64_t, float>> Decryptor::decryptTopK(const ShardedSearchResult &item,
+                                                               const SecretKey &seckey, uint32_t k,
+                                                               std::optional<double> scale) {
+    return (*impl_)->decryptShardedTopK(*getImpl(item), *getImpl(seckey), k, scale);
+}
+
+std::vector<std::pair<uint64_t, float>> Decryptor::decryptAbove(const SearchResult &item, const SecretKey &seckey,
+                                                                float threshold, std::optional<double> scale) {
+    return (*impl_)->decryptAbove(*getImpl(item), *getImpl(seckey), threshold, scale);
+}
+
+std::vector<std::pair<uint64_t, float>> Decryptor::decryptAboveTopK(const SearchResult &item, const SecretKey &seckey,
+                                                                    float threshold, uint32_t max_count,
+                                                                    std::optional<double> scale) {
+    return (*impl_)->decryptAboveTopK(*getImpl(item), *getImpl(seckey), threshold, max_count, scale);
+}
+
+void Decryptor::decryptStream(std::istream &is, const SecretKey &seckey, bool is_score,
+                              const std::function<void(uint64_t, const float *, size_t)> &on_chunk,
+                              std::optional<double> scale) {
+    (*impl_)->decryptStream(
+        is, *getImpl(seckey), is_score,
+        [&](detail::u64 offset, span<float> values) { on_chunk(offset, values.data(), values.size()); }, scale);
+}
+
+void Decryptor::setSecretKeyCacheCapacity(std::size_t capacity) {
+    (*impl_)->setSecretKeyCacheCapacity(capacity);
+}
+
+void Decryptor::setNumThreads(uint32_t num_threads) {
+    (*impl_)->setNumThreads(num_threads);
+}
+
 Decryptor makeDecryptor(const Context &context) {
     return Decryptor(std::make_shared<detail::Decryptor>(detail::makeDecryptor(*getImpl(context))));
 }
@@ -17,8 +17,10 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <algorithm>
+#include <array>
 #include <iostream>
 #include <memory>
+#include <numeric>
 
 #include "EVI/Enums.hpp"
 #include "EVI/impl/CKKSTypes.hpp"
@@ -26,24 +28,211 @@
 #include "nlohmann/json.hpp"
 #include "utils/DebUtils.hpp"
 #include "utils/Exceptions.hpp"
+#include "utils/ThreadPool.hpp"
 #include "utils/Utils.hpp"
 #include <cmath>
 #include <fstream>
+#include <functional>
+#include <future>
 
 using json = nlohmann::json;
 
 namespace evi {
 namespace detail {
+namespace {
+// Ciphertexts per on_chunk call when streaming a planar result; the default of SearchResult::serializeChunkedTo.
+constexpr u64 STREAM_CTXTS_PER_CHUNK = 16;
+
+// Runs read_chunk(buffer, first ctxt) for every chunk of num_ctxt ciphertexts and process_chunk(buffer, first ctxt)
+// once each has arrived, alternating between two buffers. Chunk k + 1 is read on its own thread while chunk k is
+// processed, so blocking IO never parks a pool worker.
+void pipelineChunks(const u64 num_ctxt, const u64 per_chunk, const std::function<void(u32, u64)> &read_chunk,
+                    const std::function<void(u32, u64)> &process_chunk) {
+    read_chunk(0, 0);
+    u32 cur = 0;
+    for (u64 first = 0; first < num_ctxt; first += per_chunk) {
+        std::future<void> next;
+        if (first + per_chunk < num_ctxt) {
+            next = std::async(std::launch::async, [&read_chunk, cur, first, per_chunk] {
+                read_chunk(cur ^ 1, first + per_chunk);
+            });
+        }
+        // Never leave the reader running on buffers that go out of scope, even if processing throws.
+        try {
+            process_chunk(cur, first);
+        } catch (...) {
+            if (next.valid()) {
+                next.wait();
+            }
+            throw;
+        }
+        if (next.valid()) {
+            next.get();
+        }
+        cur ^= 1;
+    }
+}
+} // namespace
+
 
-DecryptorInterface::DecryptorInterface(const Context &context)
-    : context_(context), deb_dec_(utils::getDebPreset(context)) {}
+DecryptWorker::DecryptWorker(const Context &context)
+    : decryptor(utils::getDebPreset(context)), view_q(context, 0), view_qp(context, 1), buf(DEGREE) {}
+
+void DecryptWorker::decrypt(const SecretKey &key, const double scale, u64 *a_q, u64 *b_q, u64 *a_p, u64 *b_p,
+                            bool is_ntt) {
+    deb::Ciphertext &deb_ctxt =
+        a_p != nullptr ? view_qp.bind(a_q, b_q, a_p, b_p, is_ntt) : view_q.bind(a_q, b_q, nullptr, nullptr, is_ntt);
+    decryptor.decrypt(deb_ctxt, key->deb_sk_, buf, scale);
+}
+
+DecryptorInterface::DecryptorInterface(const Context &context) : context_(context) {}
 
 Message DecryptorInterface::decrypt(const int idx, const Query &ctxt, const SecretKey &key,
                                     std::optional<double> scale) {
     throw evi::NotSupportedError("decrypt(idx, Query, SecretKey) is only available in EvalMode::RMP");
 }
 
-DecryptorFLAT::DecryptorFLAT(const Context &context) : DecryptorInterface(context) {}
+std::vector<Message> DecryptorInterface::decryptItems(const Query &ctxt, const SecretKey &key,
+                                                      std::optional<double> scale) {
+    throw evi::NotSupportedError("decryptItems(Query, SecretKey) is only available in EvalMode::RMP");
+}
+
+std::vector<Message> DecryptorInterface::decryptItems(const Query &ctxt, const SecretKey &key,
+                                                      const std::vector<u64> &indices, std::optional<double> scale) {
+    throw evi::NotSupportedError("decryptItems(Query, SecretKey) is only available in EvalMode::RMP");
+}
+
+Message DecryptorInterface::decryptSharded(const ShardedSearchResult &res, const SecretKey &key,
+                                           std::optional<double> scale) {
+    throw evi::NotSupportedError("decryptSharded is not supported in the current EvalMode");
+}
+
+std::vector<std::pair<u64, float>> DecryptorInterface::decryptShardedTopK(const ShardedSearchResult &res,
+                                                                          const SecretKey &key, const u64 k,
+                                                                          std::optional<double> scale) {
+    throw evi::NotSupportedError("decryptShardedTopK is not supported in the current EvalMode");
+}
+
+std::vector<Message> DecryptorInterface::decryptBatch(span<const SearchResult *> results, const SecretKey &key,
+                                                      bool is_score, std::optional<double> scale) {
+    std::vector<Message> res;
+    res.reserve(results.size());
+    for (const SearchResult *result : results) {
+        res.push_back(decrypt(*result, key, is_score, scale));
+    }
+    return res;
+}
+
+std::vector<std::pair<u64, float>> DecryptorInterface::decryptTopK(const SearchResult ctxt, const SecretKey &key,
+                                                                   const u64 k, std::optional<double> scale) {
+    throw evi::NotSupportedError("decryptTopK is not supported in the current EvalMode");
+}
+
+std::vector<std::pair<u64, float>> DecryptorInterface::decryptAbove(const SearchResult ctxt, const SecretKey &key,
+                                                                    const float threshold,
+                                                                    std::optional<double> scale) {
+    throw evi::NotSupportedError("decryptAbove is not supported in the current EvalMode");
+}
+
+std::vector<std::pair<u64, float>> DecryptorInterface::decryptAboveTopK(const SearchResult ctxt, const SecretKey &key,
+                                                                        const float threshold, const u64 max_count,
+                                                                        std::optional<double> scale) {
+    throw evi::NotSupportedError("decryptAboveTopK is not supported in the current EvalMode");
+}
+
+void DecryptorInterface::decryptStream(std::istream &is, const SecretKey &key, bool is_score,
+                                       const std::function<void(u64, span<float>)> &on_chunk,
+                                       std::optional<double> scale) {
+    throw evi::NotSupportedError("decryptStream is not supported in the current EvalMode");
+}
+
+void DecryptorInterface::setSecretKeyCacheCapacity(const std::size_t capacity) {
+    // the cache stays allocated so that loadSecKey calls running concurrently never see it go away
+    key_cache_.setCapacity(capacity);
+    if (!capacity) {
+        key_cache_.clear();
+    }
+}
+
+SecretKeyCache::Stats DecryptorInterface::getSecretKeyCacheStats() const {
+    return key_cache_.getStats();
+}
+
+void DecryptorInterface::setNumThreads(const u32 num_threads) {
+    num_threads_ = num_threads;
+}
+
+DecryptorInterface::WorkerLease::WorkerLease(DecryptorInterface &owner, const u32 count) : owner_(owner) {
+    workers_.reserve(count);
+    {
+        std::lock_guard<std::mutex> lock(owner_.worker_mutex_);
+        while (workers_.size() < count && !owner_.idle_workers_.empty()) {
+            workers_.push_back(std::move(owner_.idle_workers_.back()));
+            owner_.idle_workers_.pop_back();
+        }
+    }
+    while (workers_.size() < count) {
+        workers_.push_back(std::make_unique<DecryptWorker>(owner_.context_));
+    }
+}
+
+DecryptorInterface::WorkerLease::~WorkerLease() {
+    std::lock_guard<std::mutex> lock(owner_.worker_mutex_);
+    for (auto &worker : workers_) {
+        owner_.idle_workers_.push_back(std::move(worker));
+    }
+}
+
+u32 DecryptorInterface::numWorkers(const u64 num_jobs) const {
+    const u32 threads = num_threads_.load();
+    u32 max_threads = threads ? threads : ThreadPool::global().getNumThreads();
+    return static_cast<u32>(std::max<u64>(std::min<u64>(num_jobs, max_threads), 1));
+}
+
+void DecryptorInterface::runDecryptJobs(const u64 num_jobs,
+                                        const std::function<void(u64, u32, DecryptWorker &)> &job) {
+    runDecryptJobs(num_jobs, numWorkers(num_jobs), job);
+}
+
+void DecryptorInterface::runDecryptJobs(const u64 num_jobs, const u32 num_workers,
+                                        const std::function<void(u64, u32, DecryptWorker &)> &job) {
+    WorkerLease lease(*this, num_workers);
+    if (num_workers <= 1) {
+        for (u64 j = 0; j < num_jobs; j++) {
+            job(j, 0, lease[0]);
+        }
+        return;
+    }
+    ThreadPool::global().parallelFor(
+        num_workers,
+        [&](u64 w) {
+            DecryptWorker &worker = lease[static_cast<u32>(w)];
+            for (u64 j = w; j < num_jobs; j += num_workers) {
+                job(j, static_cast<u32>(w), worker);
+            }
+        },
+        num_workers);
+}
+
+SecretKey DecryptorInterface::loadSecKey(const std::string &key_path) {
+    if (key_cache_.enabled()) {
+        return key_cache_.load(context_, key_path);
+    }
+    return std::make_shared<SecretKeyData>(key_path);
+}
+
+SecretKey DecryptorInterface::loadSecKey(std::istream &key_stream) {
+    if (key_cache_.enabled()) {
+        return key_cache_.load(context_, key_stream);
+    }
+    SecretKey key = std::make_shared<SecretKeyData>(context_);
+    key->loadSecKey(key_stream);
+    return key;
+}
+
+DecryptorFLAT::DecryptorFLAT(const Context &context) : DecryptorInterface(context) {
+    buildScoreSlots();
+}
 DecryptorRMP::DecryptorRMP(const Context &context) : DecryptorFLAT(context) {}
 DecryptorMM::DecryptorMM(const Context &context) : DecryptorInterface(context) {}
 
@@ -52,19 +241,29 @@ DecryptorMM::DecryptorMM(const Context &context) : DecryptorInterface(context) {
  */
 Message DecryptorFLAT::decrypt(const SearchResult ip_res, std::istream &key_stream, bool is_score,
                                std::optional<double> scale) {
-    SecretKey key = std::make_shared<SecretKeyData>(context_);
-    key->loadSecKey(key_stream);
+    SecretKey key = loadSecKey(key_stream);
     return decrypt(ip_res, key, is_score, scale);
 }
 
 Message DecryptorFLAT::decrypt(const SearchResult ip_res, const std::string &key_path, bool is_score,
                                std::optional<double> scale) {
-    SecretKey key = std::make_shared<SecretKeyData>(key_path);
+    SecretKey key = loadSecKey(key_path);
     return decrypt(ip_res, key, is_score, scale);
 }
 
 Message DecryptorFLAT::decrypt(const SearchResult ip_res, const SecretKey &key, bool is_score,
                                std::optional<double> scale) {
+    Message res(getDecryptSize(ip_res), 0.0f);
+    decryptTo(ip_res, key, is_score, span<float>(res), scale);
+    return res;
+}
+
+u64 DecryptorFLAT::getDecryptSize(const SearchResult ip_res) const {
+    return (ip_res->ip_data->getPoly(0, 0).size() + DEGREE - 1) / DEGREE * DEGREE;
+}
+
+u64 DecryptorFLAT::decryptTo(const SearchResult ip_res, const SecretKey &key, bool is_score, span<float> out,
+                             std::optional<double> scale) {
     if (!key->sec_loaded_) {
         throw evi::DecryptionError("Secret key is not loaded to DecryptorImpl!");
     }
@@ -73,47 +272,385 @@ Message DecryptorFLAT::decrypt(const SearchResult ip_res, const SecretKey &key,
     if (!ctxt->getPoly(0, 0).size()) {
         throw evi::DecryptionError("Invalid Ciphertext type is given");
     }
+    const u64 size = getDecryptSize(ip_res);
+    if (out.size() < size) {
+        throw evi::InvalidInputError("Output buffer is too small for the decrypted search result");
+    }
 
-    Message res;
     double scale_factor = std::pow(2, context_->getParam()->getScaleFactor() * (is_score ? 2 : 1));
     if (scale.has_value()) {
         scale_factor = scale.value();
     }
 
-    deb::CoeffMessage buf(DEGREE);
-    for (u64 offset = 0; offset < ctxt->getPoly(0, 0).size(); offset += DEGREE) {
-        if (!ctxt->getLevel()) {
-            deb::Ciphertext deb_ctxt = utils::convertPointerToDebCipher(context_, ctxt->getPoly(1, 0).data() + offset,
-                                                                        ctxt->getPoly(0, 0).data() + offset);
-            deb_dec_.decrypt(deb_ctxt, key->deb_sk_, buf, scale_factor);
-        } else {
-            deb::Ciphertext deb_ctxt = utils::convertPointerToDebCipher(
-                context_, ctxt->getPoly(1, 0).data() + offset, ctxt->getPoly(0, 0).data() + offset,
-                ctxt->getPoly(1, 1).data() + offset, ctxt->getPoly(0, 1).data() + offset);
-            deb_dec_.decrypt(deb_ctxt, key->deb_sk_, buf, scale_factor);
+    // Every result ciphertext decrypts independently into its own DEGREE-sized slice of the output.
+    runDecryptJobs(size / DEGREE, [&](u64 c, u32, DecryptWorker &worker) {
+        const u64 offset = c * DEGREE;
+        decryptResultCtxt(*ctxt, offset, key, worker, scale_factor);
+        extractResult(worker.buf, is_score, out.data() + offset);
+    });
+    return size;
+}
+
+std::vector<Message> DecryptorFLAT::decryptBatch(span<const SearchResult *> results, const SecretKey &key,
+                                                 bool is_score, std::optional<double> scale) {
+    if (!key->sec_loaded_) {
+        throw evi::DecryptionError("Secret key is not loaded to DecryptorImpl!");
+    }
+    const double scale_factor =
+        scale.value_or(std::pow(2, context_->getParam()->getScaleFactor() * (is_score ? 2 : 1)));
+
+    // The ciphertexts of all results form one job list, so small results still fill every worker.
+    std::vector<Message> res;
+    res.reserve(results.size());
+    std::vector<u64> first_job(results.size() + 1, 0);
+    for (u64 r = 0; r < results.size(); ++r) {
+        if (!(*results[r])->ip_data->getPoly(0, 0).size()) {
+            throw evi::DecryptionError("Invalid Ciphertext type is given");
         }
+        res.emplace_back(getDecryptSize(*results[r]), 0.0f);
+        first_job[r + 1] = first_job[r] + res.back().size() / DEGREE;
+    }
 
+    runDecryptJobs(first_job.back(), [&](u64 j, u32, DecryptWorker &worker) {
+        const u64 r = std::upper_bound(first_job.begin(), first_job.end(), j) - first_job.begin() - 1;
+        const u64 offset = (j - first_job[r]) * DEGREE;
+        decryptResultCtxt(*(*results[r])->ip_data, offset, key, worker, scale_factor);
+        extractResult(worker.buf, is_score, res[r].data() + offset);
+    });
+    return res;
+}
+
+void DecryptorFLAT::extractResult(const deb::CoeffMessage &buf, bool is_score, float *dst) const {
+    if (is_score) {
+        const u32 *slots = score_slots_.data();
         for (u64 j = 0; j < DEGREE; ++j) {
-            float tmp;
-            if (is_score) {
-                tmp = buf[j % context_->getItemsPerCtxt() * context_->getPadRank() + j / context_->getItemsPerCtxt()];
-            } else {
-                tmp = buf[j];
+            dst[j] = buf[slots[j]];
+        }
+    } else {
+        for (u64 j = 0; j < DEGREE; ++j) {
+            dst[j] = buf[j];
+        }
+    }
+}
+
+std::vector<std::pair<u64, float>> DecryptorFLAT::decryptTopK(const SearchResult ip_res, const SecretKey &key,
+                                                              const u64 k, std::optional<double> scale) {
+    return selectTopScores(span<SearchResult>(&ip_res, 1), {0}, key, k, std::nullopt, scale);
+}
+
+std::vector<std::pair<u64, float>> DecryptorFLAT::decryptAboveTopK(const SearchResult ip_res, const SecretKey &key,
+                                                                   const float threshold, const u64 max_count,
+                                                                   std::optional<double> scale) {
+    return selectTopScores(span<SearchResult>(&ip_res, 1), {0}, key, max_count, threshold, scale);
+}
+
+std::vector<std::pair<u64, float>> DecryptorFLAT::decryptAbove(const SearchResult ip_res, const SecretKey &key,
+                                                               const float threshold, std::optional<double> scale) {
+    if (!key->sec_loaded_) {
+        throw evi::DecryptionError("Secret key is not loaded to DecryptorImpl!");
+    }
+    auto &ctxt = ip_res->ip_data;
+    if (!ctxt->getPoly(0, 0).size()) {
+        throw evi::DecryptionError("Invalid Ciphertext type is given");
+    }
+    const double scale_factor = scale.value_or(std::pow(2, context_->getParam()->getScaleFactor() * 2));
+    const u64 num_ctxt = (ctxt->getPoly(0, 0).size() + DEGREE - 1) / DEGREE;
+    const u64 num_items = getItemCount(ip_res);
+
+    // Hits are kept per ciphertext so that concatenating them yields index order without a sort.
+    std::vector<std::vector<std::pair<u64, float>>> hits(num_ctxt);
+    runDecryptJobs(num_ctxt, [&](u64 c, u32, DecryptWorker &worker) {
+        const u64 offset = c * DEGREE;
+        decryptResultCtxt(*ctxt, offset, key, worker, scale_factor);
+        const deb::CoeffMessage &buf = worker.buf;
+
+        // Branch-free compaction: every slot index is stored, but the cursor only advances past qualifying ones.
+        std::array<u32, DEGREE> selected;
+        const u32 *slots = score_slots_.data();
+        const u64 count = std::min<u64>(DEGREE, num_items - std::min(num_items, offset));
+        u64 num_hits = 0;
+        for (u64 j = 0; j < count; ++j) {
+            selected[num_hits] = static_cast<u32>(j);
+            num_hits += static_cast<float>(buf[slots[j]]) > threshold;
+        }
+        hits[c].reserve(num_hits);
+        for (u64 i = 0; i < num_hits; ++i) {
+            hits[c].emplace_back(offset + selected[i], static_cast<float>(buf[slots[selected[i]]]));
+        }
+    });
+
+    std::vector<std::pair<u64, float>> res;
+    for (auto &part : hits) {
+        res.insert(res.end(), part.begin(), part.end());
+    }
+    return res;
+}
+
+std::vector<std::pair<u64, float>> DecryptorFLAT::selectTopScores(span<SearchResult> results,
+                                                                  const std::vector<u64> &item_offsets,
+                                                                  const SecretKey &key, const u64 k,
+                                                                  std::optional<float> threshold,
+                                                                  std::optional<double> scale) {
+    if (!key->sec_loaded_) {
+        throw evi::DecryptionError("Secret key is not loaded to DecryptorImpl!");
+    }
+    std::vector<u64> first_job(results.size() + 1, 0);
+    for (u64 r = 0; r < results.size(); ++r) {
+        auto &ctxt = results[r]->ip_data;
+        if (!ctxt->getPoly(0, 0).size()) {
+            throw evi::DecryptionError("Invalid Ciphertext type is given");
+        }
+        first_job[r + 1] = first_job[r] + (ctxt->getPoly(0, 0).size() + DEGREE - 1) / DEGREE;
+    }
+    if (!k) {
+        return {};
+    }
+    const double scale_factor = scale.value_or(std::pow(2, context_->getParam()->getScaleFactor() * 2));
+
+    // Each worker keeps a min-heap of its k best (index, score) pairs; the heaps are merged once at the end.
+    using Entry = std::pair<u64, float>;
+    auto better = [](const Entry &lhs, const Entry &rhs) {
+        return lhs.second > rhs.second || (lhs.second == rhs.second && lhs.first < rhs.first);
+    };
+    const u32 num_workers = numWorkers(first_job.back());
+    std::vector<std::vector<Entry>> heaps(num_workers);
+    runDecryptJobs(first_job.back(), num_workers, [&](u64 job, u32 w, DecryptWorker &worker) {
+        const u64 r = std::upper_bound(first_job.begin(), first_job.end(), job) - first_job.begin() - 1;
+        const u64 offset = (job - first_job[r]) * DEGREE;
+        decryptResultCtxt(*results[r]->ip_data, offset, key, worker, scale_factor);
+        const deb::CoeffMessage &buf = worker.buf;
+
+        auto &heap = heaps[w];
+        const u64 num_items = getItemCount(results[r]);
+        const u64 count = std::min<u64>(DEGREE, num_items - std::min(num_items, offset));
+        for (u64 j = 0; j < count; ++j) {
+            Entry entry(item_offsets[r] + offset + j, static_cast<float>(buf[score_slots_[j]]));
+            if (threshold && !(entry.second > *threshold)) {
+                continue;
+            }
+            if (heap.size() < k) {
+                heap.push_back(entry);
+                std::push_heap(heap.begin(), heap.end(), better);
+            } else if (better(entry, heap.front())) {
+                std::pop_heap(heap.begin(), heap.end(), better);
+                heap.back() = entry;
+                std::push_heap(heap.begin(), heap.end(), better);
             }
-            res.push_back(tmp);
         }
+    });
+
+    std::vector<Entry> res;
+    for (auto &heap : heaps) {
+        res.insert(res.end(), heap.begin(), heap.end());
     }
+    const u64 keep = std::min<u64>(k, res.size());
+    std::partial_sort(res.begin(), res.begin() + keep, res.end(), better);
+    res.resize(keep);
     return res;
 }
 
+u64 DecryptorFLAT::getItemCount(const SearchResult &ip_res) const {
+    return utils::getResultItemCount(ip_res);
+}
+
+Message DecryptorFLAT::decryptSharded(const ShardedSearchResult &res, const SecretKey &key,
+                                      std::optional<double> scale) {
+    if (!key->sec_loaded_) {
+        throw evi::DecryptionError("Secret key is not loaded to DecryptorImpl!");
+    }
+    // Overlapping shards would have several workers writing the same scores, and gaps would size the output from
+    // offsets alone; with contiguous shards the output holds exactly the items of all shards.
+    utils::validateShardedResult(res);
+    const double scale_factor = scale.value_or(std::pow(2, context_->getParam()->getScaleFactor() * 2));
+
+    // Shards are decrypted as one job list and each writes its items straight to its global position.
+    u64 size = 0;
+    std::vector<u64> first_job(res.shards.size() + 1, 0);
+    for (u64 r = 0; r < res.shards.size(); ++r) {
+        auto &ctxt = res.shards[r]->ip_data;
+        if (!ctxt->getPoly(0, 0).size()) {
+            throw evi::DecryptionError("Invalid Ciphertext type is given");
+        }
+        first_job[r + 1] = first_job[r] + (ctxt->getPoly(0, 0).size() + DEGREE - 1) / DEGREE;
+        size += getItemCount(res.shards[r]);
+    }
+    Message scores(size, 0.0f);
+
+    runDecryptJobs(first_job.back(), [&](u64 job, u32, DecryptWorker &worker) {
+        const u64 r = std::upper_bound(first_job.begin(), first_job.end(), job) - first_job.begin() - 1;
+        const u64 offset = (job - first_job[r]) * DEGREE;
+        decryptResultCtxt(*res.shards[r]->ip_data, offset, key, worker, scale_factor);
+
+        const u64 num_items = getItemCount(res.shards[r]);
+        const u64 count = std::min<u64>(DEGREE, num_items - std::min(num_items, offset));
+        float *dst = scores.data() + res.item_offsets[r] + offset;
+        if (count == DEGREE) {
+            extractResult(worker.buf, true, dst);
+        } else {
+            // the last block of a shard may be partly padding, which must not spill into the next shard
+            std::array<float, DEGREE> tmp;
+            extractResult(worker.buf, true, tmp.data());
+            std::copy_n(tmp.begin(), count, dst);
+        }
+    });
+    return scores;
+}
+
+std::vector<std::pair<u64, float>> DecryptorFLAT::decryptShardedTopK(const ShardedSearchResult &res,
+                                                                     const SecretKey &key, const u64 k,
+                                                                     std::optional<double> scale) {
+    utils::validateShardedResult(res);
+    return selectTopScores(res.shards, res.item_offsets, key, k, std::nullopt, scale);
+}
+
+void DecryptorFLAT::decryptStream(std::istream &is, const SecretKey &key, bool is_score,
+                                  const std::function<void(u64, span<float>)> &on_chunk,
+                                  std::optional<double> scale) {
+    u8 tag = 0;
+    u32 total_count = 0;
+    is.read(reinterpret_cast<char *>(&tag), sizeof(tag));
+    is.read(reinterpret_cast<char *>(&total_count), sizeof(total_count));
+    if (!is) {
+        throw evi::InvalidInputError("Truncated search result");
+    }
+
+    utils::ResultChunkHeader header;
+    std::streampos planar_base = -1;
+    if (tag == utils::RESULT_TAG_CHUNKED) {
+        header = utils::readResultChunkHeader(is);
+    } else if (tag == 0) {
+        header = utils::readResultPlanarHeader(is);
+        header.ctxts_per_chunk = STREAM_CTXTS_PER_CHUNK;
+        planar_base = is.tellg();
+    } else {
+        throw evi::NotSupportedError("Unknown result type tag");
+    }
+    const u64 num_items = total_count ? std::min<u64>(total_count, header.num_ctxt * DEGREE) : header.num_ctxt * DEGREE;
+    if (tag == 0 && planar_base == std::streampos(-1)) {
+        decryptPlanarSequential(is, header.level, header.num_ctxt, header.ctxts_per_chunk, num_items, key, is_score,
+                                on_chunk, scale);
+        return;
+    }
+    const u64 per_chunk = std::min(header.ctxts_per_chunk, header.num_ctxt);
+    if (!per_chunk) {
+        return;
+    }
+
+    SearchResult chunks[2];
+    for (auto &chunk : chunks) {
+        chunk = SearchResult(std::make_shared<IPSearchResult>());
+        chunk->ip_data = std::make_shared<Matrix<DataType::CIPHER>>(header.level);
+    }
+    std::vector<float> out(per_chunk * DEGREE);
+    pipelineChunks(
+        header.num_ctxt, per_chunk,
+        [&](u32 buf_idx, u64 first) {
+            const u64 count = std::min(per_chunk, header.num_ctxt - first);
+            if (tag == utils::RESULT_TAG_CHUNKED) {
+                utils::readResultChunk(is, *chunks[buf_idx]->ip_data, count);
+            } else {
+                utils::readPlanarResultChunk(is, planar_base, header, *chunks[buf_idx]->ip_data, first, count);
+            }
+        },
+        [&](u32 buf_idx, u64 first) {
+            const u64 written = decryptTo(chunks[buf_idx], key, is_score, span<float>(out), scale);
+            const u64 offset = first * DEGREE;
+            if (offset < num_items) {
+                on_chunk(offset, span<float>(out.data(), std::min(written, num_items - offset)));
+            }
+        });
+    if (tag == 0) {
+        // leave the stream after the result, as a sequential read would
+        const u64 num_planes = 2 * (header.level + 1);
+        is.seekg(planar_base + static_cast<std::streamoff>(num_planes * header.num_ctxt * U64_DEGREE));
+    }
+}
+
+void DecryptorFLAT::decryptPlanarSequential(std::istream &is, const int level, const u64 num_ctxt,
+                                            const u64 ctxts_per_chunk, const u64 num_items, const SecretKey &key,
+                                            bool is_score, const std::function<void(u64, span<float>)> &on_chunk,
+                                            std::optional<double> scale) {
+    if (!key->sec_loaded_) {
+        throw evi::DecryptionError("Secret key is not loaded to DecryptorImpl!");
+    }
+    const u64 per_chunk = std::min(ctxts_per_chunk, num_ctxt);
+    if (!per_chunk) {
+        return;
+    }
+    const double scale_factor =
+        scale.value_or(std::pow(2, context_->getParam()->getScaleFactor() * (is_score ? 2 : 1)));
+
+    // A ciphertext is complete only once its polynomial in the last plane arrives. Without seeking, the leading
+    // planes (a_q, or a_q, b_q and a_p at level 1) are therefore read whole, and the last plane is streamed and
+    // decrypted chunk by chunk as it is read.
+    const u64 plane_size = num_ctxt * DEGREE;
+    const u64 num_lead_planes = 2 * (level + 1) - 1;
+    std::vector<u64> lead(num_lead_planes * plane_size);
+    is.read(reinterpret_cast<char *>(lead.data()), lead.size() * sizeof(u64));
+    if (!is) {
+        throw evi::InvalidInputError("Truncated search result");
+    }
+
+    std::vector<u64> last[2] = {std::vector<u64>(per_chunk * DEGREE), std::vector<u64>(per_chunk * DEGREE)};
+    std::vector<float> out(per_chunk * DEGREE);
+    pipelineChunks(
+        num_ctxt, per_chunk,
+        [&](u32 buf_idx, u64 first) {
+            const u64 count = std::min(per_chunk, num_ctxt - first);
+            is.read(reinterpret_cast<char *>(last[buf_idx].data()), count * U64_DEGREE);
+            if (!is) {
+                throw evi::InvalidInputError("Truncated search result");
+            }
+        },
+        [&](u32 buf_idx, u64 first) {
+            const u64 count = std::min(per_chunk, num_ctxt - first);
+            runDecryptJobs(count, [&](u64 c, u32, DecryptWorker &worker) {
+                u64 *a_q = lead.data() + (first + c) * DEGREE;
+                u64 *tail = last[buf_idx].data() + c * DEGREE;
+                if (!level) {
+                    worker.decrypt(key, scale_factor, a_q, tail);
+                } else {
+                    worker.decrypt(key, scale_factor, a_q, a_q + plane_size, a_q + 2 * plane_size, tail);
+                }
+                extractResult(worker.buf, is_score, out.data() + c * DEGREE);
+            });
+            const u64 offset = first * DEGREE;
+            if (offset < num_items) {
+                on_chunk(offset, span<float>(out.data(), std::min(count * DEGREE, num_items - offset)));
+            }
+        });
+}
+
+void DecryptorFLAT::decryptResultCtxt(IData &ctxt, const u64 offset, const SecretKey &key, DecryptWorker &worker,
+                                      const double scale) {
+    if (!ctxt.getLevel()) {
+        worker.decrypt(key, scale, ctxt.getPolyData(1, 0) + offset, ctxt.getPolyData(0, 0) + offset);
+    } else {
+        worker.decrypt(key, scale, ctxt.getPolyData(1, 0) + offset, ctxt.getPolyData(0, 0) + offset,
+                       ctxt.getPolyData(1, 1) + offset, ctxt.getPolyData(0, 1) + offset);
+    }
+}
+
+void DecryptorFLAT::buildScoreSlots() {
+    // Score j lives at coefficient (j % items) * pad_rank + j / items. Walking the coefficients item by item
+    // enumerates that table without a division per entry.
+    const u64 items = context_->getItemsPerCtxt();
+    const u64 pad_rank = context_->getPadRank();
+    score_slots_.resize(DEGREE);
+    for (u64 r = 0; r < items; ++r) {
+        for (u64 q = 0, j = r; j < DEGREE; ++q, j += items) {
+            score_slots_[j] = static_cast<u32>(r * pad_rank + q);
+        }
+    }
+}
+
 Message DecryptorFLAT::decrypt(const Query &ctxt, std::istream &key_stream, std::optional<double> scale) {
-    SecretKey key = std::make_shared<SecretKeyData>(context_);
-    key->loadSecKey(key_stream);
+    SecretKey key = loadSecKey(key_stream);
     return decrypt(ctxt, key, scale);
 }
 
 Message DecryptorFLAT::decrypt(const Query &ctxt, const std::string &key_path, std::optional<double> scale) {
-    SecretKey key = std::make_shared<SecretKeyData>(key_path);
+    SecretKey key = loadSecKey(key_path);
     return decrypt(ctxt, key, scale);
 }
 
@@ -128,22 +665,40 @@ Message DecryptorFLAT::decrypt(const Query &ctxt, const SecretKey &key, std::opt
         scale_factor = scale.value();
     }
 
-    deb::CoeffMessage tmp_msg(DEGREE);
+    // A packed FLAT batch holds several items in one ciphertext; encryptPackedFlat records their count on the query.
+    const u64 packed_count = context_->getEvalMode() == EvalMode::FLAT ? ctxt.getInnerItemCount() : 0;
+    if (packed_count && ctxt.size() != 1) {
+        throw evi::InvalidInputError("Packed FLAT query must consist of a single ciphertext");
+    }
+
+    WorkerLease lease(*this, 1);
+    DecryptWorker &worker = lease[0];
+    const deb::CoeffMessage &tmp_msg = worker.buf;
     for (int i = 0; i < ctxt.size(); i++) {
         if (ctxt[i]->getLevel() == 0) {
-            deb::Ciphertext deb_ctxt = utils::convertPointerToDebCipher(context_, ctxt[i]->getPoly(1, 0).data(),
-                                                                        ctxt[i]->getPoly(0, 0).data());
-            deb_dec_.decrypt(deb_ctxt, key->deb_sk_, tmp_msg, scale_factor);
+            worker.decrypt(key, scale_factor, ctxt[i]->getPoly(1, 0).data(), ctxt[i]->getPoly(0, 0).data());
         } else {
-            deb::Ciphertext deb_ctxt =
-                utils::convertPointerToDebCipher(context_, ctxt[i]->getPoly(1, 0).data(), ctxt[i]->getPoly(0, 0).data(),
-                                                 ctxt[i]->getPoly(1, 1).data(), ctxt[i]->getPoly(0, 1).data());
-            deb_dec_.decrypt(deb_ctxt, key->deb_sk_, tmp_msg, scale_factor);
+            worker.decrypt(key, scale_factor, ctxt[i]->getPoly(1, 0).data(), ctxt[i]->getPoly(0, 0).data(),
+                           ctxt[i]->getPoly(1, 1).data(), ctxt[i]->getPoly(0, 1).data());
         }
 
         u64 size = ctxt[i]->dim;
         u64 ctxt_dim = isPowerOfTwo(size) ? size : nextPowerOfTwo(size);
 
+        if (packed_count) {
+            const u64 count = std::min<u64>(packed_count, DEGREE / ctxt_dim);
+            Message items(count * size, 0.0f);
+            for (u64 k = 0; k < count; ++k) {
+                const u64 base = k * ctxt_dim;
+                for (u64 j = 0; j < size; ++j) {
+                    items[k * size + j] = static_cast<float>(ctxt[i]->encode_type == EncodeType::ITEM
+                                                                 ? tmp_msg[base + j]
+                                                                 : tmp_msg[base + ctxt_dim - 1 - j]);
+                }
+            }
+            return items;
+        }
+
         u64 pad_offset = ctxt_dim - ((i + 1 == ctxt.size()) ? (ctxt[i]->show_dim % ctxt[i]->dim) : 0);
         if (ctxt[i]->encode_type == EncodeType::ITEM) {
             // std::copy_n(tmp_msg.begin(), pad_offset, res.begin() + size * i);
@@ -164,47 +719,86 @@ Message DecryptorFLAT::decrypt(const Query &ctxt, const SecretKey &key, std::opt
 /**
  * DecryptorRMP
  */
+u64 DecryptorRMP::getQueryItemCount(const Query &ctxt) {
+    if (ctxt.empty()) {
+        throw evi::InvalidInputError("Cannot decrypt an empty query");
+    }
+    // QUERY-encoded ciphertexts are never batched, so they only ever hold item 0.
+    return ctxt[0]->encode_type == EncodeType::QUERY ? 1 : ctxt[0]->n;
+}
+
 Message DecryptorRMP::decrypt(const int idx, const Query &ctxt, const SecretKey &key, std::optional<double> scale) {
+    if (idx < 0 || static_cast<u64>(idx) >= getQueryItemCount(ctxt)) {
+        throw evi::InvalidInputError("Item index is out of range for this query");
+    }
+    const u64 index = static_cast<u64>(idx);
+    Message res(DEGREE, 0.0f);
+    decryptQueryItems(ctxt, key, scale, span<u64>(&index, 1), &res);
+    return res;
+}
+
+std::vector<Message> DecryptorRMP::decryptItems(const Query &ctxt, const SecretKey &key,
+                                                std::optional<double> scale) {
+    std::vector<u64> indices(getQueryItemCount(ctxt));
+    std::iota(indices.begin(), indices.end(), 0);
+    return decryptItems(ctxt, key, indices, scale);
+}
+
+std::vector<Message> DecryptorRMP::decryptItems(const Query &ctxt, const SecretKey &key,
+                                                const std::vector<u64> &indices, std::optional<double> scale) {
+    const u64 num_items = getQueryItemCount(ctxt);
+    for (u64 idx : indices) {
+        if (idx >= num_items) {
+            throw evi::InvalidInputError("Item index is out of range for this query");
+        }
+    }
+    std::vector<Message> res(indices.size(), Message(DEGREE, 0.0f));
+    if (!indices.empty()) {
+        decryptQueryItems(ctxt, key, scale, span<u64>(indices.data(), indices.size()), res.data());
+    }
+    return res;
+}
+
+void DecryptorRMP::decryptQueryItems(const Query &ctxt, const SecretKey &key, std::optional<double> scale,
+                                     span<u64> indices, Message *out) {
     if (!key->sec_loaded_) {
         throw evi::DecryptionError("Secret key is not loaded to DecryptorInterface!");
     }
-    Message res(DEGREE, 0.0f);
     double scale_factor = std::pow(2, context_->getParam()->getScaleFactor());
     if (scale.has_value()) {
         scale_factor = scale.value();
     }
 
-    deb::CoeffMessage tmp_msg(DEGREE);
+    // Each ciphertext is decrypted once, however many of its items are requested.
+    WorkerLease lease(*this, 1);
+    DecryptWorker &worker = lease[0];
+    const deb::CoeffMessage &tmp_msg = worker.buf;
     for (int i = 0; i < ctxt.size(); i++) {
         if (ctxt[i]->getLevel() == 0) {
-            deb::Ciphertext deb_ctxt = utils::convertPointerToDebCipher(context_, ctxt[i]->getPoly(1, 0).data(),
-                                                                        ctxt[i]->getPoly(0, 0).data());
-            deb_dec_.decrypt(deb_ctxt, key->deb_sk_, tmp_msg, scale_factor);
+            worker.decrypt(key, scale_factor, ctxt[i]->getPoly(1, 0).data(), ctxt[i]->getPoly(0, 0).data());
         } else {
-            deb::Ciphertext deb_ctxt =
-                utils::convertPointerToDebCipher(context_, ctxt[i]->getPoly(1, 0).data(), ctxt[i]->getPoly(0, 0).data(),
-                                                 ctxt[i]->getPoly(1, 1).data(), ctxt[i]->getPoly(0, 1).data());
-            deb_dec_.decrypt(deb_ctxt, key->deb_sk_, tmp_msg, scale_factor);
+            worker.decrypt(key, scale_factor, ctxt[i]->getPoly(1, 0).data(), ctxt[i]->getPoly(0, 0).data(),
+                           ctxt[i]->getPoly(1, 1).data(), ctxt[i]->getPoly(0, 1).data());
         }
 
         u64 size = ctxt[i]->dim;
         u64 ctxt_dim = isPowerOfTwo(size) ? size : nextPowerOfTwo(size);
 
         u64 pad_offset = ctxt_dim - ((i + 1 == ctxt.size()) ? (ctxt[i]->show_dim % ctxt[i]->dim) : 0);
-        if (ctxt[i]->encode_type == EncodeType::ITEM) {
-            // std::copy_n(tmp_msg.begin(), pad_offset, res.begin() + size * i);
-            for (u64 j = 0; j < pad_offset; ++j) {
-                res[size * i + j] = static_cast<float>(tmp_msg[j + idx * size]);
-            }
-        } else {
-            // std::reverse_copy(tmp_msg.begin() + size - pad_offset, tmp_msg.begin() + size, res.begin() + size * i);
-            for (u64 j = 0; j < pad_offset; ++j) {
-                res[size * i + j] = static_cast<float>(tmp_msg[size - 1 - j]);
+        for (u64 k = 0; k < indices.size(); ++k) {
+            Message &res = out[k];
+            const u64 idx = indices[k];
+            if (ctxt[i]->encode_type == EncodeType::ITEM) {
+                for (u64 j = 0; j < pad_offset; ++j) {
+                    res[size * i + j] = static_cast<float>(tmp_msg[j + idx * size]);
+                }
+            } else {
+                for (u64 j = 0; j < pad_offset; ++j) {
+                    res[size * i + j] = static_cast<float>(tmp_msg[size - 1 - j]);
+                }
             }
         }
     }
-
-    return res;
 }
 
 /**
@@ -212,19 +806,33 @@ Message DecryptorRMP::decrypt(const int idx, const Query &ctxt, const SecretKey
  */
 Message DecryptorMM::decrypt(const SearchResult ip_res, std::istream &key_stream, bool is_score,
                              std::optional<double> scale) {
-    SecretKey key = std::make_shared<SecretKeyData>(context_);
-    key->loadSecKey(key_stream);
+    SecretKey key = loadSecKey(key_stream);
     return decrypt(ip_res, key, is_score, scale);
 }
 
 Message DecryptorMM::decrypt(const SearchResult ip_res, const std::string &key_path, bool is_score,
                              std::optional<double> scale) {
-    SecretKey key = std::make_shared<SecretKeyData>(key_path);
+    SecretKey key = loadSecKey(key_path);
     return decrypt(ip_res, key, is_score, scale);
 }
 
 Message DecryptorMM::decrypt(const SearchResult ctxts, const evi::detail::SecretKey &seckey, bool is_score,
                              std::optional<double> scale) {
+    Message msgs(getDecryptSize(ctxts), 0.0f);
+    decryptTo(ctxts, seckey, is_score, span<float>(msgs), scale);
+    return msgs;
+}
+
+u64 DecryptorMM::getDecryptSize(const SearchResult ctxts) const {
+    size_t item_count = ctxts.getTotalItemCount() / DEGREE;
+    if (!item_count) {
+        item_count = static_cast<size_t>(ctxts->ip_data->n);
+    }
+    return static_cast<u64>(ctxts->ip_data->dim) * item_count * DEGREE;
+}
+
+u64 DecryptorMM::decryptTo(const SearchResult ctxts, const SecretKey &seckey, bool is_score, span<float> out,
+                           std::optional<double> scale) {
     double delta = scale.value_or(std::pow(2.0, context_->getParam()->getScaleFactor() * 2));
 
     auto &matrix = ctxts->ip_data;
@@ -233,48 +841,69 @@ Message DecryptorMM::decrypt(const SearchResult ctxts, const evi::detail::Secret
     }
 
     const size_t rows = static_cast<size_t>(matrix->dim);
-    size_t item_count = ctxts.getTotalItemCount() / DEGREE;
-    if (!item_count) {
-        item_count = static_cast<size_t>(matrix->n);
+    const u64 size = getDecryptSize(ctxts);
+    const size_t item_count = rows ? size / DEGREE / rows : 0;
+    if (out.size() < size) {
+        throw evi::InvalidInputError("Output buffer is too small for the decrypted search result");
     }
 
-    Message msgs(rows * item_count * DEGREE, 0.0f);
-    deb::CoeffMessage dmsg(DEGREE);
+    runDecryptJobs(rows * item_count, [&](u64 t, u32, DecryptWorker &worker) {
+        decryptMatrixCtxt(*matrix, t, item_count, seckey, delta, worker, out.data() + t * DEGREE);
+    });
+    return size;
+}
 
-    u64 *a_lvl0_base = matrix->getPolyData(1, 0);
-    u64 *b_lvl0_base = matrix->getPolyData(0, 0);
-    const int level = matrix->getLevel();
-    u64 *a_lvl1_base = level ? matrix->getPolyData(1, 1) : nullptr;
-    u64 *b_lvl1_base = level ? matrix->getPolyData(0, 1) : nullptr;
+std::vector<Message> DecryptorMM::decryptBatch(span<const SearchResult *> results, const SecretKey &key,
+                                               bool is_score, std::optional<double> scale) {
+    double delta = scale.value_or(std::pow(2.0, context_->getParam()->getScaleFactor() * 2));
 
-    for (size_t row = 0; row < rows; ++row) {
-        for (size_t item = 0; item < item_count; ++item) {
-            const size_t poly_idx = item * rows + row;
-            u64 *a_lvl0 = a_lvl0_base + poly_idx * DEGREE;
-            u64 *b_lvl0 = b_lvl0_base + poly_idx * DEGREE;
-            u64 *a_lvl1 = level ? a_lvl1_base + poly_idx * DEGREE : nullptr;
-            u64 *b_lvl1 = level ? b_lvl1_base + poly_idx * DEGREE : nullptr;
+    // Every (row, item) ciphertext of every result is one job, so a batch of small results fills all threads.
+    std::vector<Message> res;
+    res.reserve(results.size());
+    std::vector<u64> first_job(results.size() + 1, 0);
+    for (u64 r = 0; r < results.size(); ++r) {
+        if (!(*results[r])->ip_data->getPoly(0, 0).size()) {
+            throw evi::DecryptionError("Invalid Ciphertext type is given");
+        }
+        res.emplace_back(getDecryptSize(*results[r]), 0.0f);
+        first_job[r + 1] = first_job[r] + res.back().size() / DEGREE;
+    }
 
-            auto deb_ctxt = utils::convertPointerToDebCipher(context_, a_lvl0, b_lvl0, a_lvl1, b_lvl1, false);
-            deb_dec_.decrypt(deb_ctxt, seckey->deb_sk_, dmsg, delta);
+    runDecryptJobs(first_job.back(), [&](u64 j, u32, DecryptWorker &worker) {
+        const u64 r = std::upper_bound(first_job.begin(), first_job.end(), j) - first_job.begin() - 1;
+        IData &matrix = *(*results[r])->ip_data;
+        const u64 rows = static_cast<u64>(matrix.dim);
+        const u64 item_count = (first_job[r + 1] - first_job[r]) / rows;
+        const u64 t = j - first_job[r];
+        decryptMatrixCtxt(matrix, t, item_count, key, delta, worker, res[r].data() + t * DEGREE);
+    });
+    return res;
+}
 
-            float *dst = msgs.data() + (row * item_count + item) * DEGREE;
-            for (u64 k = 0; k < DEGREE; ++k) {
-                dst[k] = static_cast<float>(dmsg[k]);
-            }
-        }
+void DecryptorMM::decryptMatrixCtxt(IData &matrix, const u64 t, const u64 item_count, const SecretKey &key,
+                                    const double delta, DecryptWorker &worker, float *dst) {
+    const u64 rows = static_cast<u64>(matrix.dim);
+    const u64 poly_idx = (t % item_count) * rows + t / item_count;
+    const int level = matrix.getLevel();
+    u64 *a_lvl0 = matrix.getPolyData(1, 0) + poly_idx * DEGREE;
+    u64 *b_lvl0 = matrix.getPolyData(0, 0) + poly_idx * DEGREE;
+    u64 *a_lvl1 = level ? matrix.getPolyData(1, 1) + poly_idx * DEGREE : nullptr;
+    u64 *b_lvl1 = level ? matrix.getPolyData(0, 1) + poly_idx * DEGREE : nullptr;
+
+    worker.decrypt(key, delta, a_lvl0, b_lvl0, a_lvl1, b_lvl1, false);
+    const deb::CoeffMessage &dmsg = worker.buf;
+    for (u64 k = 0; k < DEGREE; ++k) {
+        dst[k] = static_cast<float>(dmsg[k]);
     }
-    return msgs;
 }
 
 Message DecryptorMM::decrypt(const Query &ctxts, std::istream &key_stream, std::optional<double> scale) {
-    SecretKey key = std::make_shared<SecretKeyData>(context_);
-    key->loadSecKey(key_stream);
+    SecretKey key = loadSecKey(key_stream);
     return decrypt(ctxts, key, scale);
 }
 
 Message DecryptorMM::decrypt(const Query &ctxts, const std::string &key_path, std::optional<double> scale) {
-    SecretKey key = std::make_shared<SecretKeyData>(key_path);
+    SecretKey key = loadSecKey(key_path);
     return decrypt(ctxts, key, scale);
 }
 
@@ -287,7 +916,9 @@ Message DecryptorMM::decrypt(const Query &ctxts, const SecretKey &seckey, std::o
     Message msgs(cols * msg_dim, 0.0f);
     double delta = scale.value_or(std::pow(2.0, context_->getParam()->getDBScaleFactor()));
 
-    deb::CoeffMessage tmp_msg(DEGREE);
+    WorkerLease lease(*this, 1);
+    DecryptWorker &worker = lease[0];
+    const deb::CoeffMessage &tmp_msg = worker.buf;
     const u64 stride = msg_dim;
     const u64 active_rows = std::min<u64>(rows, stride);
     const u64 active_cols = std::min<u64>(cols, static_cast<u64>(DEGREE));
@@ -298,13 +929,13 @@ Message DecryptorMM::decrypt(const Query &ctxts, const SecretKey &seckey, std::o
             throw evi::InvalidInputError("Matrix query contains null single block");
         }
 
-        deb::Ciphertext deb_ctxt =
-            block->getLevel() == 0
-                ? utils::convertPointerToDebCipher(context_, block->getPoly(1, 0).data(), block->getPoly(0, 0).data(),
-                                                   nullptr, nullptr, false)
-                : utils::convertPointerToDebCipher(context_, block->getPoly(1, 0).data(), block->getPoly(0, 0).data(),
-                                                   block->getPoly(1, 1).data(), block->getPoly(0, 1).data(), false);
-        deb_dec_.decrypt(deb_ctxt, seckey->deb_sk_, tmp_msg, delta);
+        if (block->getLevel() == 0) {
+            worker.decrypt(seckey, delta, block->getPoly(1, 0).data(), block->getPoly(0, 0).data(), nullptr, nullptr,
+                           false);
+        } else {
+            worker.decrypt(seckey, delta, block->getPoly(1, 0).data(), block->getPoly(0, 0).data(),
+                           block->getPoly(1, 1).data(), block->getPoly(0, 1).data(), false);
+        }
 
         for (u64 col = 0; col < active_cols; ++col) {
             msgs[col * stride + row] = static_cast<float>(tmp_msg[col]);
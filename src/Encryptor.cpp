@@ -23,6 +23,13 @@ namespace evi {
 
 Encryptor::Encryptor(std::shared_ptr<detail::Encryptor> impl) noexcept : impl_(std::move(impl)) {}
 
+std::shared_ptr<detail::Encryptor> &getImpl(Encryptor &enc) noexcept {
+    return enc.impl_;
+}
+const std::shared_ptr<detail::Encryptor> &getImpl(const Encryptor &enc) noexcept {
+    return enc.impl_;
+}
+
 Encryptor makeEncryptor(const Context &context, const std::optional<std::vector<uint8_t>> &seed) {
     return Encryptor(std::make_shared<detail::Encryptor>(detail::makeEncryptor(*getImpl(context), seed)));
 }
@@ -67,6 +74,28 @@ Query Encryptor::encrypt(const std::vector<float> &data, const KeyPack &keypack,
     return Query(std::make_shared<detail::Query>((*impl_)->encrypt(data, getImpl(keypack), type, level, scale)));
 }
 
+Query Encryptor::encrypt(const std::vector<uint16_t> &data, HalfFormat format, const KeyPack &keypack,
+                         evi::EncodeType type, int level, std::optional<float> scale) const {
+    return encrypt(data.data(), data.size(), format, keypack, type, level, scale);
+}
+
+Query Encryptor::encrypt(const std::vector<int8_t> &data, float quant_scale, const KeyPack &keypack,
+                         evi::EncodeType type, int level, std::optional<float> scale) const {
+    return encrypt(data.data(), data.size(), quant_scale, keypack, type, level, scale);
+}
+
+Query Encryptor::encrypt(const uint16_t *data, size_t length, HalfFormat format, const KeyPack &keypack,
+                         evi::EncodeType type, int level, std::optional<float> scale) const {
+    return Query(std::make_shared<detail::Query>(
+        (*impl_)->encrypt(span<uint16_t>(data, length), format, getImpl(keypack), type, level, scale)));
+}
+
+Query Encryptor::encrypt(const int8_t *data, size_t length, float quant_scale, const KeyPack &keypack,
+                         evi::EncodeType type, int level, std::optional<float> scale) const {
+    return Query(std::make_shared<detail::Query>(
+        (*impl_)->encrypt(span<int8_t>(data, length), quant_scale, getImpl(keypack), type, level, scale)));
+}
+
 [[deprecated("encrypt(data, type, level) will be removed soon; migrate to encrypt(data, keypack, type, level, scale)")]]
 std::vector<Query> Encryptor::encrypt(const std::vector<std::vector<float>> &data, evi::EncodeType type,
                                       int level) const {
@@ -112,11 +141,57 @@ std::vector<Query> Encryptor::encrypt(const std::vector<std::vector<float>> &dat
     return res;
 }
 
+Query Encryptor::encodeNormalized(const std::vector<float> &data, evi::EncodeType type, int level,
+                                  std::optional<float> scale, float *norm) const {
+    return Query(std::make_shared<detail::Query>((*impl_)->encodeNormalized(data, type, level, scale, norm)));
+}
+
+Query Encryptor::encryptNormalized(const std::vector<float> &data, const KeyPack &keypack, evi::EncodeType type,
+                                   int level, std::optional<float> scale, float *norm) const {
+    return Query(std::make_shared<detail::Query>(
+        (*impl_)->encryptNormalized(data, getImpl(keypack), type, level, scale, norm)));
+}
+
+std::vector<Query> Encryptor::encryptNormalized(const std::vector<std::vector<float>> &data, const KeyPack &keypack,
+                                                evi::EncodeType type, int level, std::optional<float> scale,
+                                                std::vector<float> *norms) const {
+    std::vector<detail::Query> queries =
+        (*impl_)->encryptNormalized(data, getImpl(keypack), type, level, scale, norms);
+    std::vector<Query> res;
+    res.reserve(queries.size());
+    for (auto &item : queries) {
+        res.emplace_back(std::make_shared<detail::Query>(std::move(item)));
+    }
+    return res;
+}
+
 Query Encryptor::encode(const std::vector<float> &data, evi::EncodeType type, int level,
                         std::optional<float> scale) const {
     return Query(std::make_shared<detail::Query>((*impl_)->encode(data, type, level, scale)));
 }
 
+Query Encryptor::encode(const std::vector<uint16_t> &data, HalfFormat format, evi::EncodeType type, int level,
+                        std::optional<float> scale) const {
+    return encode(data.data(), data.size(), format, type, level, scale);
+}
+
+Query Encryptor::encode(const std::vector<int8_t> &data, float quant_scale, evi::EncodeType type, int level,
+                        std::optional<float> scale) const {
+    return encode(data.data(), data.size(), quant_scale, type, level, scale);
+}
+
+Query Encryptor::encode(const uint16_t *data, size_t length, HalfFormat format, evi::EncodeType type, int level,
+                        std::optional<float> scale) const {
+    return Query(
+        std::make_shared<detail::Query>((*impl_)->encode(span<uint16_t>(data, length), format, type, level, scale)));
+}
+
+Query Encryptor::encode(const int8_t *data, size_t length, float quant_scale, evi::EncodeType type, int level,
+                        std::optional<float> scale) const {
+    return Query(std::make_shared<detail::Query>(
+        (*impl_)->encode(span<int8_t>(data, length), quant_scale, type, level, scale)));
+}
+
 std::vector<Query> Encryptor::encode(const std::vector<std::vector<float>> &data, evi::EncodeType type,
                                      int level) const {
     std::vector<Query> result;
@@ -132,4 +207,16 @@ Query Encryptor::encode(const std::vector<std::vector<float>> &msg, const Encode
     return Query(std::make_shared<detail::Query>((*impl_)->encode(msg, type, level, scale)));
 }
 
+void Encryptor::setQueryCacheCapacity(std::size_t capacity) {
+    (*impl_)->setQueryCacheCapacity(capacity);
+}
+
+void Encryptor::setFlatItemPacking(bool enable) {
+    (*impl_)->setFlatItemPacking(enable);
+}
+
+QueryCacheStats Encryptor::getQueryCacheStats() const {
+    return (*impl_)->getQueryCacheStats();
+}
+
 } // namespace evi
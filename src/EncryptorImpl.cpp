@@ -20,12 +20,15 @@
 #include "EVI/Enums.hpp"
 #include "EVI/impl/CKKSTypes.hpp"
 #include "EVI/impl/Const.hpp"
+#include "utils/Convert.hpp"
 #include "utils/DebUtils.hpp"
 #include "utils/Exceptions.hpp"
 #include "utils/Profiler.hpp"
 #include "utils/Sampler.hpp"
+#include "utils/ThreadPool.hpp"
 #include "utils/Utils.hpp"
 #include <algorithm>
+#include <cmath>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -37,18 +40,22 @@
 namespace evi {
 namespace detail {
 
+EncryptWorker::EncryptWorker(const Context &context, const std::optional<std::vector<u8>> &seed)
+    : encryptor(utils::getDebPreset(context), utils::convertDebSeed(seed)), view_q(context, 0), view_qp(context, 1),
+      buf(DEGREE) {}
+
 template <EvalMode M>
 EncryptorImpl<M>::EncryptorImpl(const Context &context, const std::optional<std::vector<u8>> &seed)
     : context_(context), sampler_(context, seed),
-      deb_encryptor_(utils::getDebPreset(context), utils::convertDebSeed(seed)),
-      deb_enc_key_(utils::getDebContext(context), deb::SWK_ENC) {}
+      main_worker_(context, seed),
+      deb_enc_key_(utils::getDebContext(context), deb::SWK_ENC), seeded_(seed.has_value()) {}
 
 template <EvalMode M>
 EncryptorImpl<M>::EncryptorImpl(const Context &context, const KeyPack &keypack,
                                 const std::optional<std::vector<u8>> &seed)
     : context_(context), sampler_(context, seed),
-      deb_encryptor_(utils::getDebPreset(context), utils::convertDebSeed(seed)),
-      deb_enc_key_(utils::getDebContext(context), deb::SWK_ENC) {
+      main_worker_(context, seed),
+      deb_enc_key_(utils::getDebContext(context), deb::SWK_ENC), seeded_(seed.has_value()) {
     loadEncKey(keypack);
 }
 
@@ -56,16 +63,16 @@ template <EvalMode M>
 EncryptorImpl<M>::EncryptorImpl(const Context &context, const std::string &dir_path,
                                 const std::optional<std::vector<u8>> &seed)
     : context_(context), sampler_(context, seed),
-      deb_encryptor_(utils::getDebPreset(context), utils::convertDebSeed(seed)),
-      deb_enc_key_(utils::getDebContext(context), deb::SWK_ENC) {
+      main_worker_(context, seed),
+      deb_enc_key_(utils::getDebContext(context), deb::SWK_ENC), seeded_(seed.has_value()) {
     loadEncKey(dir_path);
 }
 
 template <EvalMode M>
 EncryptorImpl<M>::EncryptorImpl(const Context &context, std::istream &in, const std::optional<std::vector<u8>> &seed)
     : context_(context), sampler_(context, seed),
-      deb_encryptor_(utils::getDebPreset(context), utils::convertDebSeed(seed)),
-      deb_enc_key_(utils::getDebContext(context), deb::SWK_ENC) {
+      main_worker_(context, seed),
+      deb_enc_key_(utils::getDebContext(context), deb::SWK_ENC), seeded_(seed.has_value()) {
     loadEncKey(in);
 }
 
@@ -109,6 +116,98 @@ void EncryptorImpl<M>::loadEncKey(const KeyPack &kp) {
     }
 }
 
+/**
+ * ===========================
+ *      Quantized inputs
+ * ===========================
+ */
+
+namespace {
+double sumSquares(const float *values, const u64 count) {
+    double sum = 0.0;
+    for (u64 i = 0; i < count; ++i) {
+        sum += static_cast<double>(values[i]) * values[i];
+    }
+    return sum;
+}
+
+// Gain that scales a vector with the given sum of squares to unit length (zero vectors are left as is); norm, when
+// non-null, receives the L2 norm.
+double normalizingGain(const double sum_squares, float *norm) {
+    const double l2 = std::sqrt(sum_squares);
+    if (norm) {
+        *norm = static_cast<float>(l2);
+    }
+    return l2 > 0.0 ? 1.0 / l2 : 1.0;
+}
+
+// Normalizing gain of every vector, for batch paths that spread an item over several ciphertexts and so need its
+// gain before its first slice is placed.
+std::vector<double> normalizingGains(const std::vector<std::vector<float>> &msg, std::vector<float> *norms) {
+    std::vector<double> gains(msg.size());
+    for (u64 i = 0; i < msg.size(); ++i) {
+        gains[i] = normalizingGain(sumSquares(msg[i].data(), msg[i].size()), norms ? &(*norms)[i] : nullptr);
+    }
+    return gains;
+}
+
+// Batch paths copy every item into its ciphertext slot anyway, so a per-item gain is applied to that copy. The
+// product is formed in double and rounded to fp32 once.
+double itemGain(const double *gains, const u64 item) {
+    return gains ? gains[item] : 1.0;
+}
+
+void applyGain(float *values, const u64 count, const double gain) {
+    if (gain != 1.0) {
+        std::transform(values, values + count, values, [gain](float v) { return static_cast<float>(v * gain); });
+    }
+}
+
+using EncodeBlocks = std::vector<std::array<float, DEGREE>>;
+
+// Lays msg out over num_blocks encode buffers of block_size values each, reversing every block for QUERY. With
+// normalize set, the sum of squares is accumulated from the freshly written buffers and the normalizing gain is
+// returned, so the input is read only once; otherwise the gain is 1.
+double fillEncodeBlocks(const utils::InputVector &msg, const u64 block_size, const u64 num_blocks, const bool reverse,
+                        const bool normalize, float *norm, EncodeBlocks &blocks) {
+    blocks.assign(num_blocks, {});
+    double sum_squares = 0.0;
+    for (u64 j = 0; j < num_blocks; ++j) {
+        const u64 offset = j * block_size;
+        const u64 count = std::min(block_size, msg.size() - offset);
+        float *dst = blocks[j].data();
+        msg.copyTo(offset, count, dst);
+        if (normalize) {
+            sum_squares += sumSquares(dst, count);
+        }
+        if (reverse) {
+            std::reverse(dst, dst + block_size);
+        }
+    }
+    return normalize ? normalizingGain(sum_squares, norm) : 1.0;
+}
+} // namespace
+
+Query EncryptorInterface::encode(const span<u16> msg, const HalfFormat format, const EncodeType type,
+                                 const bool level, std::optional<float> scale) {
+    return encodeInput(utils::InputVector(msg, format), type, level, scale);
+}
+
+Query EncryptorInterface::encode(const span<i8> msg, const float quant_scale, const EncodeType type,
+                                 const bool level, std::optional<float> scale) {
+    return encodeInput(utils::InputVector(msg, quant_scale), type, level, scale);
+}
+
+Query EncryptorInterface::encrypt(const span<u16> msg, const HalfFormat format, const KeyPack &keypack,
+                                  const EncodeType type, const bool level, std::optional<float> scale) {
+    return encryptInput(utils::InputVector(msg, format), keypack, type, level, scale);
+}
+
+Query EncryptorInterface::encrypt(const span<i8> msg, const float quant_scale, const KeyPack &keypack,
+                                  const EncodeType type, const bool level, std::optional<float> scale) {
+    return encryptInput(utils::InputVector(msg, quant_scale), keypack, type, level, scale);
+}
+
 /**
  * ===========================
  *           Encrypt
@@ -174,7 +273,7 @@ Query EncryptorImpl<M>::encrypt(const span<float> msg, const MultiSecretKey &sec
         throw InvalidAccessError("Inappropriate API usage");
     }
 
-    poly ctxt_a_q, copy_a_q, ctxt_b_q, ctxt_b_p, ctxt_a_p;
+    poly ctxt_a_q, copy_a_q, ctxt_b_q;
 
     sampler_.sampleUniformModQ(ctxt_a_q);
     for (u64 i = 0; i < DEGREE; i++) {
@@ -222,34 +321,51 @@ Query EncryptorImpl<M>::encrypt(const span<float> msg, const MultiSecretKey &sec
     }
 
     // Shared-a to HERS Query (query unpacking)
-    Query res;
+    // Every database is switched independently from the same modUp'd a, which the workers only read.
     poly up_p;
     context_->modUp(tmp_res[0], up_p);
-    for (u64 j = 0; j < num_db; j++) {
-        context_->multModQ(tmp_res[0], switch_key_->getPolyData(0, 0) + (j % context_->getPadRank()) * DEGREE,
-                           ctxt_b_q);
-        context_->multModP(up_p, switch_key_->getPolyData(0, 1) + (j % context_->getPadRank()) * DEGREE, ctxt_b_p);
-        context_->multModQ(tmp_res[0], switch_key_->getPolyData(1, 0) + (j % context_->getPadRank()) * DEGREE,
-                           ctxt_a_q);
-        context_->multModP(up_p, switch_key_->getPolyData(1, 1) + (j % context_->getPadRank()) * DEGREE, ctxt_a_p);
-        context_->modDown(ctxt_a_q, ctxt_a_p);
-        context_->modDown(ctxt_b_q, ctxt_b_p);
-        context_->addModQ(ctxt_b_q, tmp_res[j + 1], ctxt_b_q);
-        res.push_back(std::make_shared<SingleBlock<DataType::CIPHER>>(ctxt_a_q, ctxt_b_q));
-        res.back()->n = 1;
-        res.back()->degree = DEGREE;
-        res.back()->dim = context_->getPadRank();
-        res.back()->show_dim = msg.size();
-        res.back()->encode_type = type;
-    }
-
-    return res;
+    Query::SingleContainer blocks(num_db);
+    ThreadPool::global().parallelFor(num_db, [&](u64 j) {
+        auto block = std::make_shared<SingleBlock<DataType::CIPHER>>(0);
+        polydata out_a_q = block->getPolyData(1, 0);
+        polydata out_b_q = block->getPolyData(0, 0);
+        poly out_a_p, out_b_p;
+        u64 key_offset = (j % context_->getPadRank()) * DEGREE;
+        context_->multModQ(tmp_res[0], switch_key_->getPolyData(0, 0) + key_offset, span<u64>(out_b_q, DEGREE));
+        context_->multModP(up_p, switch_key_->getPolyData(0, 1) + key_offset, out_b_p);
+        context_->multModQ(tmp_res[0], switch_key_->getPolyData(1, 0) + key_offset, span<u64>(out_a_q, DEGREE));
+        context_->multModP(up_p, switch_key_->getPolyData(1, 1) + key_offset, out_a_p);
+        context_->modDown(span<u64>(out_a_q, DEGREE), out_a_p);
+        context_->modDown(span<u64>(out_b_q, DEGREE), out_b_p);
+        context_->addModQ(span<u64>(out_b_q, DEGREE), tmp_res[j + 1], span<u64>(out_b_q, DEGREE));
+        block->n = 1;
+        block->degree = DEGREE;
+        block->dim = context_->getPadRank();
+        block->show_dim = msg.size();
+        block->encode_type = type;
+        blocks[j] = std::move(block);
+    });
+
+    return Query(std::move(blocks));
 }
 
 // encrypt using encryption key
 template <EvalMode M>
 Query EncryptorImpl<M>::encrypt(const span<float> msg, const EncodeType type, const bool level,
                                 std::optional<float> scale) {
+    return encryptInput(msg, type, level, scale);
+}
+
+template <EvalMode M>
+Query EncryptorImpl<M>::encryptInput(const utils::InputVector &msg, const KeyPack &keypack, const EncodeType type,
+                                     const bool level, std::optional<float> scale) {
+    loadEncKey(keypack);
+    return encryptInput(msg, type, level, scale);
+}
+
+template <EvalMode M>
+Query EncryptorImpl<M>::encryptInput(const utils::InputVector &msg, const EncodeType type, const bool level,
+                                     std::optional<float> scale, const bool normalize, float *norm) {
     if constexpr (CHECK_SHARED_A(M) || CHECK_MM(M)) {
         throw evi::NotSupportedError("Encryption is not supported in the current EvalMode shared-a or MM");
     }
@@ -261,18 +377,16 @@ Query EncryptorImpl<M>::encrypt(const span<float> msg, const EncodeType type, co
     }
     double delta = scale.value_or(std::pow(2.0, context_->getParam()->getScaleFactor()));
 
+    // Encryption carries no scale metadata, so a normalizing gain simply rides on the encoding scale.
     Query res;
+    EncodeBlocks blocks;
     if constexpr (!CHECK_RMP(M)) {
-        std::array<float, DEGREE> tmp_msg{};
-        if (type == EncodeType::ITEM) {
-            std::copy_n(msg.begin(), msg.size(), tmp_msg.begin());
-        } else {
-            u64 pad_size = isPowerOfTwo(msg.size()) ? msg.size() : nextPowerOfTwo(msg.size());
-            u64 pad_offset = pad_size - msg.size();
-            std::reverse_copy(msg.begin(), msg.end(), tmp_msg.begin() + pad_offset);
-        }
+        // QUERY pads to a power of two and reverses the whole slot, which leaves the values at its tail.
+        const u64 slot_size = type == EncodeType::ITEM || isPowerOfTwo(msg.size()) ? msg.size()
+                                                                                   : nextPowerOfTwo(msg.size());
+        delta *= fillEncodeBlocks(msg, slot_size, 1, type == EncodeType::QUERY, normalize, norm, blocks);
 
-        auto s = innerEncrypt(tmp_msg, level, delta);
+        auto s = innerEncrypt(blocks[0], level, delta);
         s->n = 1;
         s->dim = msg.size();
         s->show_dim = msg.size();
@@ -283,27 +397,84 @@ Query EncryptorImpl<M>::encrypt(const span<float> msg, const EncodeType type, co
         uint32_t tmp_dim = msg.size();
         uint32_t tmp_rank = getInnerRank(tmp_dim);
         uint32_t num_db = (tmp_dim + tmp_rank - 1) / tmp_rank;
-        u64 copy_offset = 0;
-        for (u64 j = 0; j < num_db; j++) {
-            std::array<float, DEGREE> tmp_msg{};
-            u64 copy_size = copy_offset + tmp_rank <= msg.size() ? tmp_rank : msg.size() - copy_offset;
-            std::copy_n(msg.begin() + copy_offset, copy_size, tmp_msg.begin());
-            if (type == EncodeType::QUERY) {
-                std::reverse(tmp_msg.begin(), tmp_msg.begin() + tmp_rank);
-            }
-            copy_offset += copy_size;
-            auto tmp = innerEncrypt(tmp_msg, level, delta);
+
+        delta *= fillEncodeBlocks(msg, tmp_rank, num_db, type == EncodeType::QUERY, normalize, norm, blocks);
+
+        Query::SingleContainer ctxts(num_db);
+        auto encrypt_block = [&](u64 j, EncryptWorker *worker) {
+            auto tmp = innerEncrypt(blocks[j], level, delta, std::nullopt, true, worker);
             tmp->n = 1;
             tmp->dim = tmp_rank;
             tmp->show_dim = msg.size();
             tmp->degree = DEGREE;
             tmp->encode_type = type;
-            res.push_back(tmp);
-        }
+            ctxts[j] = std::move(tmp);
+        };
+
+        // A high-dimension vector spans several ciphertexts; spread them over the pool, one encryptor per worker.
+        runEncryptJobs(num_db, encrypt_block);
+        res = Query(std::move(ctxts));
     }
     return res;
 }
 
+template <EvalMode M>
+void EncryptorImpl<M>::runEncryptJobs(const u64 num_jobs, const std::function<void(u64, EncryptWorker *)> &job) {
+    u32 num_workers = numEncryptWorkers(num_jobs);
+    if (num_workers <= 1) {
+        for (u64 j = 0; j < num_jobs; j++) {
+            job(j, nullptr);
+        }
+        return;
+    }
+    // Each call works on its own leased encryptors, so concurrent batch encrypts never share deb RNG state.
+    // If a job throws, the leased encryptors are simply dropped instead of going back to the pool.
+    auto workers = leaseWorkerEncryptors(num_workers);
+    ThreadPool::global().parallelFor(num_workers, [&](u64 w) {
+        for (u64 j = w; j < num_jobs; j += num_workers) {
+            job(j, workers[w].get());
+        }
+    });
+    returnWorkerEncryptors(std::move(workers));
+}
+
+template <EvalMode M>
+u32 EncryptorImpl<M>::numEncryptWorkers(const u64 num_jobs) const {
+    // A seeded encryptor has to stay reproducible: all jobs run in order on main_worker_, so the output only
+    // depends on the seed and never on how the jobs were split across threads.
+    if (seeded_) {
+        return 1;
+    }
+    u32 num_workers = static_cast<u32>(std::min<u64>(num_jobs, ThreadPool::global().getNumThreads()));
+    return std::max<u32>(num_workers, 1);
+}
+
+template <EvalMode M>
+std::vector<std::unique_ptr<EncryptWorker>> EncryptorImpl<M>::leaseWorkerEncryptors(const u32 num_workers) {
+    std::vector<std::unique_ptr<EncryptWorker>> workers;
+    workers.reserve(num_workers);
+    {
+        std::lock_guard<std::mutex> lock(worker_mutex_);
+        while (workers.size() < num_workers && !idle_encryptors_.empty()) {
+            workers.push_back(std::move(idle_encryptors_.back()));
+            idle_encryptors_.pop_back();
+        }
+    }
+    while (workers.size() < num_workers) {
+        workers.push_back(
+            std::make_unique<EncryptWorker>(context_, std::nullopt));
+    }
+    return workers;
+}
+
+template <EvalMode M>
+void EncryptorImpl<M>::returnWorkerEncryptors(std::vector<std::unique_ptr<EncryptWorker>> &&workers) {
+    std::lock_guard<std::mutex> lock(worker_mutex_);
+    for (auto &worker : workers) {
+        idle_encryptors_.push_back(std::move(worker));
+    }
+}
+
 // batch encrypt using encryption key
 
 template <EvalMode M>
@@ -342,6 +513,13 @@ std::vector<Query> EncryptorImpl<M>::encrypt(const std::vector<std::vector<float
 template <EvalMode M>
 std::vector<Query> EncryptorImpl<M>::encrypt(const std::vector<std::vector<float>> &msg, const EncodeType type,
                                              const bool level, std::optional<float> scale) {
+    return encryptBatch(msg, type, level, scale, /* normalize */ false, nullptr);
+}
+
+template <EvalMode M>
+std::vector<Query> EncryptorImpl<M>::encryptBatch(const std::vector<std::vector<float>> &msg, const EncodeType type,
+                                                  const bool level, std::optional<float> scale, const bool normalize,
+                                                  std::vector<float> *norms) {
     if (!enc_loaded_) {
         throw evi::EncryptionError("Encryption key is not loaded for encryption");
     }
@@ -357,6 +535,12 @@ std::vector<Query> EncryptorImpl<M>::encrypt(const std::vector<std::vector<float
         uint32_t tmp_rank = getInnerRank(tmp_dim);
         uint32_t num_db = (tmp_dim + tmp_rank - 1) / tmp_rank;
 
+        std::vector<double> item_gains;
+        if (normalize) {
+            item_gains = normalizingGains(msg, norms);
+        }
+        const double *gains = normalize ? item_gains.data() : nullptr;
+
         uint32_t total_items = msg.size();
         uint32_t num_item_per_ctxt = DEGREE / tmp_rank;
         std::vector<Query> res;
@@ -398,8 +582,9 @@ std::vector<Query> EncryptorImpl<M>::encrypt(const std::vector<std::vector<float
                     if (copy_size < 0) {
                         copy_size = 0;
                     }
-                    std::copy_n(msg[i].begin() + db_idx * tmp_rank, copy_size,
-                                inner_msg.begin() + (i % num_item_per_ctxt) * tmp_rank);
+                    float *dst = inner_msg.data() + (i % num_item_per_ctxt) * tmp_rank;
+                    std::copy_n(msg[i].begin() + db_idx * tmp_rank, copy_size, dst);
+                    applyGain(dst, copy_size, itemGain(gains, i));
                 }
 
                 Query::SingleQuery tmp = innerEncrypt(inner_msg, level, delta);
@@ -427,8 +612,9 @@ std::vector<Query> EncryptorImpl<M>::encrypt(const std::vector<std::vector<float
                         if (copy_size < 0) {
                             copy_size = 0;
                         }
-                        std::copy_n(msg[i].begin() + db_idx * tmp_rank, copy_size,
-                                    inner_msg.begin() + (i - start_idx) * tmp_rank);
+                        float *dst = inner_msg.data() + (i - start_idx) * tmp_rank;
+                        std::copy_n(msg[i].begin() + db_idx * tmp_rank, copy_size, dst);
+                        applyGain(dst, copy_size, itemGain(gains, i));
                     }
 
                     Query::SingleQuery tmp = innerEncrypt(inner_msg, level, delta);
@@ -444,10 +630,15 @@ std::vector<Query> EncryptorImpl<M>::encrypt(const std::vector<std::vector<float
         }
         return res;
     } else if constexpr (M == EvalMode::FLAT) {
+        if (flat_packing_) {
+            return encryptPackedFlat(msg, type, level, scale, normalize, norms);
+        }
+        // One item per ciphertext: each item is normalized like a single encrypt.
         std::vector<Query> res;
         res.reserve(msg.size());
-        for (const auto &item : msg) {
-            res.emplace_back(encrypt(evi::span<float>(item), type, level, scale));
+        for (u64 i = 0; i < msg.size(); ++i) {
+            res.emplace_back(encryptInput(span<float>(msg[i]), type, level, scale, normalize,
+                                          norms ? &(*norms)[i] : nullptr));
         }
         return res;
     } else {
@@ -455,9 +646,88 @@ std::vector<Query> EncryptorImpl<M>::encrypt(const std::vector<std::vector<float
     }
 }
 
+template <EvalMode M>
+Query EncryptorImpl<M>::encryptNormalized(const span<float> msg, const KeyPack &keypack, const EncodeType type,
+                                          const bool level, std::optional<float> scale, float *norm) {
+    loadEncKey(keypack);
+    return encryptInput(msg, type, level, scale, /* normalize */ true, norm);
+}
+
+template <EvalMode M>
+std::vector<Query> EncryptorImpl<M>::encryptNormalized(const std::vector<std::vector<float>> &msg,
+                                                       const KeyPack &keypack, const EncodeType type,
+                                                       const bool level, std::optional<float> scale,
+                                                       std::vector<float> *norms) {
+    loadEncKey(keypack);
+    if (norms) {
+        norms->resize(msg.size());
+    }
+
+    // Items sharing a ciphertext need their own gains, so each path applies them while placing the items.
+    if constexpr (CHECK_MM(M)) {
+        return encryptMM(msg, type, level, scale, normalizingGains(msg, norms).data());
+    } else {
+        return encryptBatch(msg, type, level, scale, /* normalize */ true, norms);
+    }
+}
+
+template <EvalMode M>
+std::vector<Query> EncryptorImpl<M>::encryptPackedFlat(const std::vector<std::vector<float>> &msg,
+                                                       const EncodeType type, const bool level,
+                                                       std::optional<float> scale, const bool normalize,
+                                                       std::vector<float> *norms) {
+    const u64 dim = msg[0].size();
+    if (!dim || dim > DEGREE) {
+        throw evi::EncryptionError("Invalid data type for encryption! Input message must has its size");
+    }
+    for (const auto &item : msg) {
+        if (item.size() != dim) {
+            throw evi::EncryptionError("Packed FLAT encryption requires all vectors to have the same dimension");
+        }
+    }
+
+    // Items sit at power-of-two strides, laid out exactly as a single FLAT encrypt would place them in its slot.
+    const u64 stride = isPowerOfTwo(dim) ? dim : nextPowerOfTwo(dim);
+    const u64 items_per_ctxt = DEGREE / stride;
+    const u64 num_ctxt = (msg.size() + items_per_ctxt - 1) / items_per_ctxt;
+    double delta = scale.value_or(std::pow(2.0, context_->getParam()->getScaleFactor()));
+
+    std::vector<Query> res(num_ctxt);
+    runEncryptJobs(num_ctxt, [&](u64 c, EncryptWorker *worker) {
+        const u64 first = c * items_per_ctxt;
+        const u64 count = std::min<u64>(items_per_ctxt, msg.size() - first);
+        std::array<float, DEGREE> tmp_msg{};
+        for (u64 k = 0; k < count; ++k) {
+            const auto &item = msg[first + k];
+            float *dst = tmp_msg.data() + k * stride + (type == EncodeType::ITEM ? 0 : stride - dim);
+            if (type == EncodeType::ITEM) {
+                std::copy_n(item.begin(), dim, dst);
+            } else {
+                std::reverse_copy(item.begin(), item.end(), dst);
+            }
+            // each item sits whole in this ciphertext, so its norm is taken from the copy that was just written
+            if (normalize) {
+                float *norm = norms ? &(*norms)[first + k] : nullptr;
+                applyGain(dst, dim, normalizingGain(sumSquares(dst, dim), norm));
+            }
+        }
+
+        auto s = innerEncrypt(tmp_msg, level, delta, std::nullopt, true, worker);
+        s->n = count;
+        s->dim = dim;
+        s->show_dim = dim;
+        s->degree = DEGREE;
+        s->encode_type = type;
+        res[c].emplace_back(std::move(s));
+        res[c].setInnerItemCount(count);
+        res[c].setItemCount(count);
+    });
+    return res;
+}
+
 template <EvalMode M>
 std::vector<Query> EncryptorImpl<M>::encryptMM(const std::vector<std::vector<float>> &msg, const EncodeType type,
-                                               const bool level, std::optional<float> scale) {
+                                               const bool level, std::optional<float> scale, const double *gains) {
     if (!msg.size()) {
         throw evi::EncryptionError("EncryptorImpl<M>::encryptMM Nothing to encrypt! Input message must has its size");
     }
@@ -474,26 +744,39 @@ std::vector<Query> EncryptorImpl<M>::encryptMM(const std::vector<std::vector<flo
     std::vector<Query> queries;
     queries.reserve(batch);
 
+    // Each ciphertext holds one row across DEGREE items. Rather than striding over every item per row, rows are
+    // transposed MM_TILE_ROWS at a time so that each item is read one cache line at a time.
+    std::vector<float> tile(static_cast<size_t>(MM_TILE_ROWS) * DEGREE);
     for (int b = 0; b < batch; b++) {
         const size_t col_offset = static_cast<size_t>(b) * static_cast<size_t>(cols);
         const size_t remaining_cols = col_offset < msg.size() ? (msg.size() - col_offset) : 0;
         const u32 col_base = static_cast<u32>(std::min(static_cast<size_t>(cols), remaining_cols));
+        if (col_base < DEGREE) {
+            std::fill(tile.begin(), tile.end(), 0.0f);
+        }
 
         Query q;
         q.reserve(rows);
-        for (u64 i = 0; i < static_cast<u64>(rows); ++i) {
-
-            std::array<float, DEGREE> coeff_msg{};
+        for (u64 row_base = 0; row_base < static_cast<u64>(rows); row_base += MM_TILE_ROWS) {
+            const u64 tile_rows = std::min<u64>(MM_TILE_ROWS, rows - row_base);
             for (u64 j = 0; j < static_cast<u64>(col_base); ++j) {
-                coeff_msg[j] = static_cast<float>(msg[col_offset + j][i]);
+                const float *src = msg[col_offset + j].data() + row_base;
+                const double g = itemGain(gains, col_offset + j);
+                for (u64 t = 0; t < tile_rows; ++t) {
+                    tile[t * DEGREE + j] = static_cast<float>(src[t] * g);
+                }
+            }
+
+            for (u64 t = 0; t < tile_rows; ++t) {
+                Query::SingleQuery tmp = innerEncrypt(span<float>(tile.data() + t * DEGREE, DEGREE), level, delta,
+                                                      std::nullopt, /*is_ntt*/ false);
+                tmp->n = col_base;
+                tmp->dim = static_cast<u64>(rows);
+                tmp->show_dim = static_cast<u64>(rows);
+                tmp->degree = DEGREE;
+                tmp->encode_type = type;
+                q.push_back(tmp);
             }
-            Query::SingleQuery tmp = innerEncrypt(coeff_msg, level, delta, std::nullopt, /*is_ntt*/ false);
-            tmp->n = col_base;
-            tmp->dim = static_cast<u64>(rows);
-            tmp->show_dim = static_cast<u64>(rows);
-            tmp->degree = DEGREE;
-            tmp->encode_type = type;
-            q.push_back(tmp);
         }
         queries.emplace_back(std::move(q));
     }
@@ -502,16 +785,25 @@ std::vector<Query> EncryptorImpl<M>::encryptMM(const std::vector<std::vector<flo
 
 template <EvalMode M>
 Query::SingleQuery EncryptorImpl<M>::innerEncrypt(const span<float> &msg, const bool level, const double scale,
-                                                  std::optional<const SecretKey> seckey, std::optional<bool> ntt) {
-    poly ctxt_a_q, ctxt_b_q;
-    poly ctxt_a_p, ctxt_b_p;
-    deb::Ciphertext deb_ctxt =
-        level ? utils::convertPointerToDebCipher(context_, ctxt_a_q.data(), ctxt_b_q.data(), ctxt_a_p.data(),
-                                                 ctxt_b_p.data())
-              : utils::convertPointerToDebCipher(context_, ctxt_a_q.data(), ctxt_b_q.data(), nullptr, nullptr);
-
-    // convert message
-    deb::CoeffMessage deb_msg(DEGREE);
+                                                  std::optional<const SecretKey> seckey, std::optional<bool> ntt,
+                                                  EncryptWorker *worker) {
+    auto res = std::make_shared<SingleBlock<DataType::CIPHER>>(level ? LEVEL1 : 0);
+    innerEncryptTo(msg, level, scale, res->getPolyData(1, 0), res->getPolyData(0, 0),
+                   level ? res->getPolyData(1, 1) : nullptr, level ? res->getPolyData(0, 1) : nullptr, seckey, ntt,
+                   worker);
+    return res;
+}
+
+template <EvalMode M>
+void EncryptorImpl<M>::innerEncryptTo(const span<float> &msg, const bool level, const double scale, polydata a_q,
+                                      polydata b_q, polydata a_p, polydata b_p, std::optional<const SecretKey> seckey,
+                                      std::optional<bool> ntt, EncryptWorker *worker) {
+    EncryptWorker &w = worker ? *worker : main_worker_;
+    deb::Encryptor &deb_encryptor = w.encryptor;
+    deb::Ciphertext &deb_ctxt = level ? w.view_qp.bind(a_q, b_q, a_p, b_p) : w.view_q.bind(a_q, b_q);
+
+    // convert message into the worker's buffer
+    deb::CoeffMessage &deb_msg = w.buf;
     for (size_t i = 0; i < DEGREE; ++i) {
         if (i < msg.size()) {
             deb_msg[i] = static_cast<double>(msg[i]);
@@ -523,17 +815,11 @@ Query::SingleQuery EncryptorImpl<M>::innerEncrypt(const span<float> &msg, const
     // encrypt with deb_encryptor
     bool ntt_val = ntt.value_or(true);
     if (seckey.has_value()) {
-        deb_encryptor_.encrypt(deb_msg, (*seckey)->deb_sk_, deb_ctxt,
-                               deb::EncryptOptions().Scale(scale).Level(level).NttOut(ntt_val));
-    } else {
-        deb_encryptor_.encrypt(deb_msg, deb_enc_key_, deb_ctxt,
-                               deb::EncryptOptions().Scale(scale).Level(level).NttOut(ntt_val));
-    }
-
-    if (level) {
-        return std::make_shared<SingleBlock<DataType::CIPHER>>(ctxt_a_q, ctxt_a_p, ctxt_b_q, ctxt_b_p);
+        deb_encryptor.encrypt(deb_msg, (*seckey)->deb_sk_, deb_ctxt,
+                              deb::EncryptOptions().Scale(scale).Level(level).NttOut(ntt_val));
     } else {
-        return std::make_shared<SingleBlock<DataType::CIPHER>>(ctxt_a_q, ctxt_b_q);
+        deb_encryptor.encrypt(deb_msg, deb_enc_key_, deb_ctxt,
+                              deb::EncryptOptions().Scale(scale).Level(level).NttOut(ntt_val));
     }
 }
 
@@ -555,12 +841,66 @@ Query EncryptorImpl<M>::encode(const std::vector<std::vector<float>> &msg, const
     return res;
 }
 
+template <EvalMode M>
+void EncryptorImpl<M>::setQueryCacheCapacity(const std::size_t capacity) {
+    // the cache stays allocated so that encode calls running concurrently never see it go away
+    query_cache_.setCapacity(capacity);
+    if (!capacity) {
+        query_cache_.clear();
+    }
+}
+
+template <EvalMode M>
+QueryCacheStats EncryptorImpl<M>::getQueryCacheStats() const {
+    return query_cache_.getStats();
+}
+
+template <EvalMode M>
+void EncryptorImpl<M>::setFlatItemPacking(const bool enable) {
+    if constexpr (M != EvalMode::FLAT) {
+        throw evi::NotSupportedError("Item packing is only supported in EvalMode::FLAT");
+    }
+    flat_packing_ = enable;
+}
+
 template <EvalMode M>
 Query EncryptorImpl<M>::encode(const span<float> msg, const EncodeType type, const bool level,
                                std::optional<float> scale) {
+    return encodeInput(msg, type, level, scale);
+}
+
+template <EvalMode M>
+Query EncryptorImpl<M>::encodeInput(const utils::InputVector &msg, const EncodeType type, const bool level,
+                                    std::optional<float> scale) {
     if (!msg.size()) {
         throw evi::EncryptionError("Invalid data type for encryption! Input message must has its size");
     }
+    if (query_cache_.enabled()) {
+        if (auto cached = query_cache_.find(msg, type, level, scale)) {
+            return *cached;
+        }
+        Query res = encodeUncached(msg, type, level, scale);
+        query_cache_.insert(msg, type, level, scale, res);
+        return res;
+    }
+    return encodeUncached(msg, type, level, scale);
+}
+
+template <EvalMode M>
+Query EncryptorImpl<M>::encodeNormalized(const span<float> msg, const EncodeType type, const bool level,
+                                         std::optional<float> scale, float *norm) {
+    if (!msg.size()) {
+        throw evi::EncryptionError("Invalid data type for encryption! Input message must has its size");
+    }
+    // The query cache is keyed on the raw input, so normalized encodes bypass it.
+    return encodeUncached(msg, type, level, scale, /* normalize */ true, norm);
+}
+
+// With normalize set, the normalizing gain multiplies every input value as it is scaled to an integer; the recorded
+// scale_bit is unaffected.
+template <EvalMode M>
+Query EncryptorImpl<M>::encodeUncached(const utils::InputVector &msg, const EncodeType type, const bool level,
+                                       std::optional<float> scale, const bool normalize, float *norm) {
     u64 scale_bits;
     if (scale.has_value()) {
         scale_bits = static_cast<u64>(std::log2(scale.value()));
@@ -569,13 +909,15 @@ Query EncryptorImpl<M>::encode(const span<float> msg, const EncodeType type, con
     }
     double delta = scale.value_or(std::pow(2.0, scale_bits));
 
-    u64 pad_size = 0;
     Query res;
+    EncodeBlocks blocks;
     if constexpr (CHECK_MM(M)) {
         if (type != EncodeType::QUERY) {
             throw evi::NotSupportedError("Only EncodeType::QUERY is supported for EvalMode::MM.");
         }
-        auto tmp = innerEncode(msg, level, delta, msg.size(), /* ntt */ false);
+        const u64 msg_size = std::min<u64>(msg.size(), DEGREE);
+        delta *= fillEncodeBlocks(msg, msg_size, 1, false, normalize, norm, blocks);
+        auto tmp = innerEncode(blocks[0], level, delta, msg_size, /* ntt */ false);
         tmp->n = 1;
         tmp->dim = msg.size();
         tmp->degree = DEGREE;
@@ -588,16 +930,9 @@ Query EncryptorImpl<M>::encode(const span<float> msg, const EncodeType type, con
         uint32_t tmp_dim = msg.size();
         uint32_t tmp_rank = getInnerRank(tmp_dim);
         uint32_t num_db = (tmp_dim + tmp_rank - 1) / tmp_rank;
-        u64 copy_offset = 0;
+        delta *= fillEncodeBlocks(msg, tmp_rank, num_db, type == EncodeType::QUERY, normalize, norm, blocks);
         for (u64 j = 0; j < num_db; j++) {
-            std::array<float, DEGREE> tmp_msg{};
-            u64 copy_size = copy_offset + tmp_rank <= msg.size() ? tmp_rank : msg.size() - copy_offset;
-            std::copy_n(msg.begin() + copy_offset, copy_size, tmp_msg.begin());
-            if (type == EncodeType::QUERY) {
-                std::reverse(tmp_msg.begin(), tmp_msg.begin() + tmp_rank);
-            }
-            copy_offset += copy_size;
-            auto tmp = innerEncode(tmp_msg, level, delta, tmp_rank);
+            auto tmp = innerEncode(blocks[j], level, delta, tmp_rank);
             tmp->n = 1;
             tmp->dim = tmp_rank;
             tmp->show_dim = msg.size();
@@ -608,24 +943,21 @@ Query EncryptorImpl<M>::encode(const span<float> msg, const EncodeType type, con
         }
 
     } else if constexpr (M == EvalMode::RMS) {
+        // RMS encodes at the base scale factor rather than the query scale factor used above.
+        const u64 rms_scale_bits =
+            scale.has_value() ? scale_bits : static_cast<u64>(context_->getParam()->getScaleFactor());
         uint32_t tmp_dim = msg.size();
         uint32_t tmp_rank = getInnerRank(tmp_dim);
         uint32_t num_db = (tmp_dim + tmp_rank - 1) / tmp_rank;
-        u64 copy_offset = 0;
+        const double rms_delta =
+            scale.value_or(std::pow(2.0, rms_scale_bits)) *
+            fillEncodeBlocks(msg, tmp_rank, num_db, type == EncodeType::QUERY, normalize, norm, blocks);
         for (u64 j = 0; j < num_db; j++) {
-            std::array<float, DEGREE> tmp_msg{};
-            u64 copy_size = copy_offset + tmp_rank <= msg.size() ? tmp_rank : msg.size() - copy_offset;
-            std::copy_n(msg.begin() + copy_offset, copy_size, tmp_msg.begin());
-            if (type == EncodeType::QUERY) {
-                std::reverse(tmp_msg.begin(), tmp_msg.begin() + tmp_rank);
-            }
-            copy_offset += copy_size;
-
-            double delta = scale.value_or(std::pow(2.0, context_->getParam()->getScaleFactor()));
+            const auto &tmp_msg = blocks[j];
             poly plaintext_q{};
 
             for (u64 i = 0; i < tmp_rank; ++i) {
-                i128 temp = static_cast<i128>(tmp_msg[i] * delta + (tmp_msg[i] > 0 ? 0.5 : -0.5));
+                i128 temp = static_cast<i128>(tmp_msg[i] * rms_delta + (tmp_msg[i] > 0 ? 0.5 : -0.5));
                 bool is_positive = temp >= 0;
                 temp = is_positive ? temp : -temp;
 
@@ -636,21 +968,23 @@ Query EncryptorImpl<M>::encode(const span<float> msg, const EncodeType type, con
                 plaintext_q[i] = is_positive ? value_q : (context_->getParam()->getPrimeQ() - value_q);
             }
             context_->nttModQMini(plaintext_q, tmp_rank);
-            polyvec128 tmp(plaintext_q.begin(), plaintext_q.end());
-            res.emplace_back(std::make_shared<SerializedSingleQuery<DataType::PLAIN>>(tmp));
+            auto tmp = std::make_shared<SerializedSingleQuery<DataType::PLAIN>>(plaintext_q);
+            tmp->n = 1;
+            tmp->dim = tmp_rank;
+            tmp->show_dim = msg.size();
+            tmp->degree = DEGREE;
+            tmp->encode_type = type;
+            tmp->scale_bit = rms_scale_bits;
+            res.emplace_back(tmp);
         }
 
     } else {
-        std::array<float, DEGREE> tmp_msg{};
-        if (type == EncodeType::ITEM) {
-            std::copy_n(msg.begin(), msg.size(), tmp_msg.begin());
-        } else {
-            pad_size = isPowerOfTwo(msg.size()) ? msg.size() : nextPowerOfTwo(msg.size());
-            u64 pad_offset = pad_size - msg.size();
-            std::reverse_copy(msg.begin(), msg.end(), tmp_msg.begin() + pad_offset);
-        }
+        // QUERY pads to a power of two and reverses the whole slot, which leaves the values at its tail.
+        const u64 slot_size = type == EncodeType::ITEM || isPowerOfTwo(msg.size()) ? msg.size()
+                                                                                   : nextPowerOfTwo(msg.size());
+        delta *= fillEncodeBlocks(msg, slot_size, 1, type == EncodeType::QUERY, normalize, norm, blocks);
 
-        auto tmp = innerEncode(tmp_msg, level, delta);
+        auto tmp = innerEncode(blocks[0], level, delta);
         tmp->n = 1;
         tmp->dim = msg.size();
         tmp->degree = DEGREE;
@@ -665,32 +999,70 @@ Query EncryptorImpl<M>::encode(const span<float> msg, const EncodeType type, con
 template <EvalMode M>
 Query::SingleQuery EncryptorImpl<M>::innerEncode(const span<float> &msg, const bool level, const double scale,
                                                  std::optional<const u64> msg_size, std::optional<bool> ntt) {
-    Query::SingleQuery res;
-    poly plaintext_q{};
-    std::optional<poly> plaintext_p;
+    auto res = std::make_shared<SingleBlock<DataType::PLAIN>>(level ? LEVEL1 : 0);
+    innerEncodeTo(msg, level, scale, res->getPolyData(0, 0), level ? res->getPolyData(0, 1) : nullptr, msg_size,
+                  ntt);
+    return res;
+}
+
+template <EvalMode M>
+void EncryptorImpl<M>::innerEncodeTo(const span<float> &msg, const bool level, const double scale, polydata q,
+                                     polydata p, std::optional<const u64> msg_size, std::optional<bool> ntt) {
+    span<u64> plaintext_q(q, DEGREE);
+    std::optional<span<u64>> plaintext_p;
     if (level) {
-        poly tmp{};
-        plaintext_p = tmp;
+        plaintext_p = span<u64>(p, DEGREE);
     }
 
-    u64 num_iter = msg_size.value_or(DEGREE);
-    for (u64 i = 0; i < num_iter; ++i) {
-        i128 temp = static_cast<i128>(msg[i] * scale + signBiasDouble(msg[i]));
-        i64 is_positive = temp >= 0;
-        temp = absI128(temp);
+    const auto &param = context_->getParam();
+    const u64 prime_q = param->getPrimeQ();
+    const u64 barr_q = param->getBarrRatioQ();
+    const u64 prime_p = level ? param->getPrimeP() : 0;
+    const u64 barr_p = level ? param->getBarrRatioP() : 0;
 
-        u64 value_q = reduceBarrett(context_->getParam()->getPrimeQ(), context_->getParam()->getTwoPrimeQ(),
-                                    context_->getParam()->getTwoTo64Q(), context_->getParam()->getTwoTo64ShoupQ(),
-                                    context_->getParam()->getBarrRatioQ(), static_cast<u128>(temp));
-        plaintext_q[i] = selectIfCondU64(is_positive, value_q, context_->getParam()->getPrimeQ() - value_q);
+    u64 num_iter = std::min<u64>(msg_size.value_or(DEGREE), msg.size());
 
+    // Scaled coefficients almost always fit in 64 bits. Encode optimistically with a branch-free 64-bit loop that the
+    // compiler can vectorize, tracking the largest magnitude on the way; the clamp only keeps the conversion defined.
+    // If any coefficient did not fit, redo the block with the 128-bit reduction.
+    constexpr double fit_bound = 0x1p63 - 1024;
+    double max_abs = 0.0;
+    for (u64 i = 0; i < num_iter; ++i) {
+        const double v = msg[i] * scale + signBiasDouble(msg[i]);
+        max_abs = std::max(max_abs, std::fabs(v));
+        i64 temp = static_cast<i64>(std::clamp(v, -fit_bound, fit_bound));
+        i64 sign = temp >> 63;
+        u64 abs_temp = static_cast<u64>((temp + sign) ^ sign);
+
+        u64 value_q = reduceBarrett(prime_q, barr_q, abs_temp);
+        plaintext_q[i] = selectIfCondU64(sign == 0, value_q, prime_q - value_q);
         if (level) {
-            u64 value_p = reduceBarrett(context_->getParam()->getPrimeP(), context_->getParam()->getTwoPrimeP(),
-                                        context_->getParam()->getTwoTo64P(), context_->getParam()->getTwoTo64ShoupP(),
-                                        context_->getParam()->getBarrRatioP(), static_cast<u128>(temp));
-            plaintext_p.value()[i] = selectIfCondU64(is_positive, value_p, context_->getParam()->getPrimeP() - value_p);
+            u64 value_p = reduceBarrett(prime_p, barr_p, abs_temp);
+            plaintext_p.value()[i] = selectIfCondU64(sign == 0, value_p, prime_p - value_p);
         }
     }
+    if (max_abs > fit_bound) {
+        for (u64 i = 0; i < num_iter; ++i) {
+            i128 temp = static_cast<i128>(msg[i] * scale + signBiasDouble(msg[i]));
+            i64 is_positive = temp >= 0;
+            temp = absI128(temp);
+
+            u64 value_q = reduceBarrett(prime_q, param->getTwoPrimeQ(), param->getTwoTo64Q(),
+                                        param->getTwoTo64ShoupQ(), barr_q, static_cast<u128>(temp));
+            plaintext_q[i] = selectIfCondU64(is_positive, value_q, prime_q - value_q);
+
+            if (level) {
+                u64 value_p = reduceBarrett(prime_p, param->getTwoPrimeP(), param->getTwoTo64P(),
+                                            param->getTwoTo64ShoupP(), barr_p, static_cast<u128>(temp));
+                plaintext_p.value()[i] = selectIfCondU64(is_positive, value_p, prime_p - value_p);
+            }
+        }
+    }
+    // the destination may be a slice of a larger buffer, so clear the unused tail explicitly
+    std::fill(plaintext_q.begin() + num_iter, plaintext_q.end(), 0);
+    if (level) {
+        std::fill(plaintext_p->begin() + num_iter, plaintext_p->end(), 0);
+    }
 
     if (ntt.value_or(true)) {
         if (msg_size.has_value()) {
@@ -705,12 +1077,6 @@ Query::SingleQuery EncryptorImpl<M>::innerEncode(const span<float> &msg, const b
             }
         }
     }
-    if (level) {
-        res = std::make_shared<SingleBlock<DataType::PLAIN>>(plaintext_q, plaintext_p.value());
-    } else {
-        res = std::make_shared<SingleBlock<DataType::PLAIN>>(plaintext_q);
-    }
-    return res;
 }
 
 /**
@@ -732,43 +1098,29 @@ Blob EncryptorImpl<M>::encrypt(const span<float> msg, const int num_items, const
         throw evi::EncryptionError("Invalid dimension for bulk encryption! Input message size must be power of two");
     }
 
+    double delta = scale.value_or(std::pow(2.0, context_->getParam()->getScaleFactor()));
+
+    // Every ciphertext is written straight into its slice of the output Matrix, which is sized once up front.
     Blob res;
     if constexpr (!CHECK_RMP(M)) {
-        polyvec a_q, b_q;
-        std::optional<polyvec> a_p, b_p;
-        if (level) {
-            polyvec tmp_a, tmp_b;
-            a_p = tmp_a;
-            b_p = tmp_b;
+        if constexpr (CHECK_SHARED_A(M) || CHECK_MM(M)) {
+            throw evi::NotSupportedError("Encryption is not supported in the current EvalMode shared-a or MM");
         }
+        u64 num_ctxt = (msg.size() + DEGREE - 1) / DEGREE;
+        auto tmp = std::make_shared<Matrix<DataType::CIPHER>>(level ? LEVEL1 : 0);
+        tmp->setSize(num_ctxt * DEGREE);
 
         for (u64 offset = 0; offset < msg.size(); offset += DEGREE) {
             auto tmp_span = msg.subspan(offset, DEGREE);
-            auto tmp = encrypt(tmp_span, EncodeType::ITEM, level, scale);
-            a_q.insert(a_q.end(), tmp[0]->getPoly(1, 0).begin(), tmp[0]->getPoly(1, 0).end());
-            b_q.insert(b_q.end(), tmp[0]->getPoly(0, 0).begin(), tmp[0]->getPoly(0, 0).end());
-            if (level) {
-                a_p.value().insert(a_p.value().end(), tmp[0]->getPoly(1, 1).begin(), tmp[0]->getPoly(1, 1).end());
-                b_p.value().insert(b_p.value().end(), tmp[0]->getPoly(0, 1).begin(), tmp[0]->getPoly(0, 1).end());
-            }
+            innerEncryptTo(tmp_span, level, delta, tmp->getPolyData(1, 0) + offset, tmp->getPolyData(0, 0) + offset,
+                           level ? tmp->getPolyData(1, 1) + offset : nullptr,
+                           level ? tmp->getPolyData(0, 1) + offset : nullptr);
         }
 
-        if (level) {
-            auto tmp = std::make_shared<Matrix<DataType::CIPHER>>(a_q, a_p.value(), b_q, b_p.value());
-            tmp->dim = msg.size() / num_items;
-            tmp->n = num_items;
-            tmp->degree = DEGREE;
-
-            res.emplace_back(tmp);
-
-        } else {
-            auto tmp = std::make_shared<Matrix<DataType::CIPHER>>(a_q, b_q);
-            tmp->dim = msg.size() / num_items;
-            tmp->n = num_items;
-            tmp->degree = DEGREE;
-
-            res.emplace_back(tmp);
-        }
+        tmp->dim = msg.size() / num_items;
+        tmp->n = num_items;
+        tmp->degree = DEGREE;
+        res.emplace_back(tmp);
     } else {
         uint32_t tmp_dim = msg.size() / num_items;
         uint32_t tmp_rank = getInnerRank(tmp_dim);
@@ -776,19 +1128,12 @@ Blob EncryptorImpl<M>::encrypt(const span<float> msg, const int num_items, const
         uint32_t num_item_per_ctxt = DEGREE / tmp_rank;
         uint32_t num_ctxt = (num_items + num_item_per_ctxt - 1) / num_item_per_ctxt;
 
+        res.reserve(num_db);
         for (u32 db_idx = 0; db_idx < num_db; ++db_idx) {
-            polyvec a_q, b_q;
-            std::optional<polyvec> a_p, b_p;
-            if (level) {
-                polyvec tmp_a, tmp_b;
-                a_p = tmp_a;
-                b_p = tmp_b;
-            }
+            auto tmp = std::make_shared<Matrix<DataType::CIPHER>>(level ? LEVEL1 : 0);
+            tmp->setSize(num_ctxt * DEGREE);
 
             for (u32 ctxt_idx = 0; ctxt_idx < num_ctxt; ++ctxt_idx) {
-
-                auto num_item_per_ctxt = DEGREE / tmp_rank;
-
                 std::array<float, DEGREE> inner_msg{};
                 for (int i = 0; i < num_item_per_ctxt; i++) {
                     auto copy_size = std::min(int32_t(msg.size()) - int32_t(num_db * DEGREE * ctxt_idx +
@@ -801,29 +1146,16 @@ Blob EncryptorImpl<M>::encrypt(const span<float> msg, const int num_items, const
                                 copy_size, inner_msg.begin() + i * tmp_rank);
                 }
 
-                double delta = scale.value_or(std::pow(2.0, context_->getParam()->getScaleFactor()));
-                Query::SingleQuery tmp = innerEncrypt(inner_msg, level, delta);
-                tmp->n = 1;
-                tmp->dim = tmp_rank;
-                tmp->degree = DEGREE;
-                a_q.insert(a_q.end(), tmp->getPoly(1, 0).begin(), tmp->getPoly(1, 0).end());
-                b_q.insert(b_q.end(), tmp->getPoly(0, 0).begin(), tmp->getPoly(0, 0).end());
-                if (level) {
-                    a_p.value().insert(a_p.value().end(), tmp->getPoly(1, 1).begin(), tmp->getPoly(1, 1).end());
-                    b_p.value().insert(b_p.value().end(), tmp->getPoly(0, 1).begin(), tmp->getPoly(0, 1).end());
-                }
-            }
-
-            if (level) {
-                res.push_back(std::make_shared<Matrix<DataType::CIPHER>>(a_q, a_p.value(), b_q, b_p.value()));
-
-            } else {
-                res.push_back(std::make_shared<Matrix<DataType::CIPHER>>(a_q, b_q));
+                u64 offset = static_cast<u64>(ctxt_idx) * DEGREE;
+                innerEncryptTo(inner_msg, level, delta, tmp->getPolyData(1, 0) + offset,
+                               tmp->getPolyData(0, 0) + offset, level ? tmp->getPolyData(1, 1) + offset : nullptr,
+                               level ? tmp->getPolyData(0, 1) + offset : nullptr);
             }
 
-            res[db_idx]->n = num_items;
-            res[db_idx]->dim = tmp_rank;
-            res[db_idx]->degree = DEGREE;
+            tmp->n = num_items;
+            tmp->dim = tmp_rank;
+            tmp->degree = DEGREE;
+            res.push_back(tmp);
         }
     }
 
@@ -842,49 +1174,38 @@ Blob EncryptorImpl<M>::encode(const span<float> msg, const int num_items, const
 
     Blob res;
     if constexpr (!CHECK_RMP(M)) {
-        polyvec q;
-        std::optional<polyvec> p;
-        if (level) {
-            polyvec tmp_p;
-            p = tmp_p;
+        if constexpr (CHECK_MM(M)) {
+            throw evi::NotSupportedError("Only EncodeType::QUERY is supported for EvalMode::MM.");
         }
+        double delta = scale.value_or(std::pow(2.0, context_->getParam()->getQueryScaleFactor()));
+        u64 num_ptxt = (msg.size() + DEGREE - 1) / DEGREE;
+        auto tmp = std::make_shared<Matrix<DataType::PLAIN>>(level ? LEVEL1 : 0);
+        tmp->setSize(num_ptxt * DEGREE);
 
         for (u64 offset = 0; offset < msg.size(); offset += DEGREE) {
             auto tmp_span = msg.subspan(offset, DEGREE);
-            auto tmp = encode(tmp_span, EncodeType::ITEM, level, scale);
-            q.insert(q.end(), tmp[0]->getPoly(0, 0).begin(), tmp[0]->getPoly(0, 0).end());
-            if (level) {
-                p.value().insert(p.value().end(), tmp[0]->getPoly(0, 1).begin(), tmp[0]->getPoly(0, 1).end());
-            }
-        }
-
-        if (level) {
-            res.emplace_back(std::make_shared<Matrix<DataType::PLAIN>>(q, p.value()));
-        } else {
-            res.emplace_back(std::make_shared<Matrix<DataType::PLAIN>>(q));
+            innerEncodeTo(tmp_span, level, delta, tmp->getPolyData(0, 0) + offset,
+                          level ? tmp->getPolyData(0, 1) + offset : nullptr);
         }
 
-        res[0]->dim = msg.size() / num_items;
-        res[0]->n = num_items;
-        res[0]->degree = DEGREE;
+        tmp->dim = msg.size() / num_items;
+        tmp->n = num_items;
+        tmp->degree = DEGREE;
+        res.emplace_back(tmp);
     } else {
         uint32_t tmp_dim = msg.size() / num_items;
         uint32_t tmp_rank = getInnerRank(tmp_dim);
         uint32_t num_db = (tmp_dim + tmp_rank - 1) / tmp_rank;
         uint32_t num_item_per_ctxt = DEGREE / tmp_rank;
         uint32_t num_ctxt = (num_items + num_item_per_ctxt - 1) / num_item_per_ctxt;
+        double delta = scale.value_or(std::pow(2.0, context_->getParam()->getScaleFactor()));
 
+        res.reserve(num_db);
         for (u32 db_idx = 0; db_idx < num_db; ++db_idx) {
-            polyvec q;
-            std::optional<polyvec> p;
-            if (level) {
-                polyvec tmp_p;
-                p = tmp_p;
-            }
+            auto tmp = std::make_shared<Matrix<DataType::PLAIN>>(level ? LEVEL1 : 0);
+            tmp->setSize(num_ctxt * DEGREE);
 
             for (u32 ctxt_idx = 0; ctxt_idx < num_ctxt; ++ctxt_idx) {
-                auto num_item_per_ctxt = DEGREE / tmp_rank;
-
                 std::array<float, DEGREE> inner_msg{};
                 for (int i = 0; i < num_item_per_ctxt; i++) {
                     auto copy_size = std::min(int32_t(msg.size()) - int32_t(num_db * DEGREE * ctxt_idx +
@@ -897,27 +1218,15 @@ Blob EncryptorImpl<M>::encode(const span<float> msg, const int num_items, const
                                 copy_size, inner_msg.begin() + i * tmp_rank);
                 }
 
-                double delta = scale.value_or(std::pow(2.0, context_->getParam()->getScaleFactor()));
-                Query::SingleQuery tmp = innerEncode(inner_msg, level, delta);
-                tmp->n = 1;
-                tmp->dim = tmp_rank;
-                tmp->degree = DEGREE;
-                q.insert(q.end(), tmp->getPoly(0, 0).begin(), tmp->getPoly(0, 0).end());
-                if (level) {
-                    p.value().insert(p.value().end(), tmp->getPoly(0, 1).begin(), tmp->getPoly(0, 1).end());
-                }
+                u64 offset = static_cast<u64>(ctxt_idx) * DEGREE;
+                innerEncodeTo(inner_msg, level, delta, tmp->getPolyData(0, 0) + offset,
+                              level ? tmp->getPolyData(0, 1) + offset : nullptr);
             }
 
-            if (level) {
-                res.push_back(std::make_shared<Matrix<DataType::PLAIN>>(q, p.value()));
-
-            } else {
-                res.push_back(std::make_shared<Matrix<DataType::PLAIN>>(q));
-            }
-
-            res[db_idx]->n = num_items;
-            res[db_idx]->dim = tmp_rank;
-            res[db_idx]->degree = DEGREE;
+            tmp->n = num_items;
+            tmp->dim = tmp_rank;
+            tmp->degree = DEGREE;
+            res.push_back(tmp);
         }
     }
     return res;
@@ -0,0 +1,64 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (C) 2025, CryptoLab, Inc.                                       //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//     http://www.apache.org/licenses/LICENSE-2.0                             //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "EVI/ItemPacker.hpp"
+#include "EVI/impl/ItemPackerImpl.hpp"
+#include "utils/Exceptions.hpp"
+
+namespace evi {
+
+ItemPacker::ItemPacker(std::shared_ptr<detail::ItemPacker> impl) noexcept : impl_(std::move(impl)) {}
+
+ItemPacker makeItemPacker(const Encryptor &encryptor, const KeyPack &keypack, int level, std::optional<float> scale) {
+    const auto &enc = getImpl(encryptor);
+    if (!enc) {
+        throw InvalidInputError("makeItemPacker: Encryptor is not initialized");
+    }
+    return ItemPacker(std::make_shared<detail::ItemPacker>(*enc, getImpl(keypack), level, scale));
+}
+
+std::vector<Query> ItemPacker::add(const std::vector<std::vector<float>> &items) {
+    std::vector<detail::Query> queries = impl_->add(items);
+    std::vector<Query> res;
+    res.reserve(queries.size());
+    for (auto &item : queries) {
+        res.emplace_back(std::make_shared<detail::Query>(std::move(item)));
+    }
+    return res;
+}
+
+std::vector<Query> ItemPacker::flush() {
+    std::vector<detail::Query> queries = impl_->flush();
+    std::vector<Query> res;
+    res.reserve(queries.size());
+    for (auto &item : queries) {
+        res.emplace_back(std::make_shared<detail::Query>(std::move(item)));
+    }
+    return res;
+}
+
+uint32_t ItemPacker::getPendingCount() const {
+    return impl_->getPendingCount();
+}
+
+uint32_t ItemPacker::getItemsPerCiphertext() const {
+    return impl_->getItemsPerCiphertext();
+}
+
+} // namespace evi
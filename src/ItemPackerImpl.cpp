@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (C) 2025, CryptoLab, Inc.                                       //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//     http://www.apache.org/licenses/LICENSE-2.0                             //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "EVI/impl/ItemPackerImpl.hpp"
+#include "utils/Exceptions.hpp"
+#include "utils/Utils.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace evi {
+namespace detail {
+
+ItemPacker::ItemPacker(const Encryptor &encryptor, const KeyPack &keypack, const bool level,
+                       std::optional<float> scale)
+    : encryptor_(encryptor), keypack_(keypack), level_(level), scale_(scale) {
+    if (!encryptor_) {
+        throw InvalidInputError("ItemPacker requires an encryptor");
+    }
+    if (encryptor_->getEvalMode() != EvalMode::RMP) {
+        throw NotSupportedError("ItemPacker is only supported in EvalMode::RMP");
+    }
+}
+
+std::vector<Query> ItemPacker::add(const std::vector<std::vector<float>> &items) {
+    for (const auto &item : items) {
+        if (item.empty()) {
+            throw InvalidInputError("ItemPacker::add: item must have its size");
+        }
+        if (!dim_) {
+            dim_ = item.size();
+            items_per_ctxt_ = static_cast<u32>(DEGREE / getInnerRank(dim_));
+            pending_.reserve(items_per_ctxt_);
+        } else if (item.size() != dim_) {
+            throw InvalidInputError("ItemPacker::add: all items must have the same dimension");
+        }
+    }
+    const u64 full = (pending_.size() + items.size()) / items_per_ctxt_ * items_per_ctxt_;
+    if (!full) {
+        pending_.insert(pending_.end(), items.begin(), items.end());
+        return {};
+    }
+    // Whole multiples of items_per_ctxt encrypt to exactly full / items_per_ctxt completely filled queries.
+    // pending_ always holds less than one ciphertext, so it is moved to the front of the batch and only the new
+    // items are copied, each exactly once. Items are only dropped from pending_ once encryption succeeded.
+    const u64 from_pending = pending_.size();
+    const u64 from_items = full - from_pending;
+    std::vector<std::vector<float>> batch;
+    batch.reserve(full);
+    std::move(pending_.begin(), pending_.end(), std::back_inserter(batch));
+    batch.insert(batch.end(), items.begin(), items.begin() + from_items);
+
+    std::vector<Query> res;
+    try {
+        res = encryptor_->encrypt(batch, keypack_, EncodeType::ITEM, level_, scale_);
+    } catch (...) {
+        std::move(batch.begin(), batch.begin() + from_pending, pending_.begin());
+        throw;
+    }
+    pending_.assign(items.begin() + from_items, items.end());
+    return res;
+}
+
+std::vector<Query> ItemPacker::flush() {
+    if (pending_.empty()) {
+        return {};
+    }
+    std::vector<Query> res = encryptor_->encrypt(pending_, keypack_, EncodeType::ITEM, level_, scale_);
+    pending_.clear();
+    return res;
+}
+
+} // namespace detail
+} // namespace evi
@@ -18,6 +18,7 @@
 
 #include "EVI/Query.hpp"
 #include "EVI/impl/CKKSTypes.hpp"
+#include "utils/BufferStream.hpp"
 #include "utils/Utils.hpp"
 
 namespace evi {
@@ -62,8 +63,14 @@ Query Query::deserializeFrom(std::istream &is) {
 }
 
 Query Query::deserializeFromString(const std::string &data) {
-    std::istringstream iss(data, std::ios::binary);
-    return deserializeFrom(iss);
+    return deserializeFromBuffer(data.data(), data.size());
+}
+
+Query Query::deserializeFromBuffer(const void *data, std::size_t size) {
+    Query query;
+    detail::utils::deserializeFromBuffer(static_cast<const char *>(data), size,
+                                         [&](std::istream &is) { query = deserializeFrom(is); });
+    return query;
 }
 
 void Query::serializeTo(const Query &query, std::ostream &os) {
@@ -71,9 +78,18 @@ void Query::serializeTo(const Query &query, std::ostream &os) {
 }
 
 void Query::serializeToString(const Query &query, std::string &out) {
-    std::ostringstream oss(std::ios::binary);
-    Query::serializeTo(query, oss);
-    out = oss.str();
+    out.clear();
+    detail::utils::serializeAppend(out, getSerializedSize(query),
+                                   [&](std::ostream &os) { Query::serializeTo(query, os); });
+}
+
+std::size_t Query::getSerializedSize(const Query &query) {
+    return detail::utils::getQuerySerializedSize(*query.impl_);
+}
+
+void Query::serializeToBuffer(const Query &query, void *out, std::size_t size) {
+    detail::utils::serializeToBuffer(static_cast<char *>(out), size,
+                                     [&](std::ostream &os) { Query::serializeTo(query, os); });
 }
 
 void Query::serializeVectorTo(const std::vector<Query> &queries, std::ostream &os) {
@@ -85,9 +101,12 @@ void Query::serializeVectorTo(const std::vector<Query> &queries, std::ostream &o
 }
 
 void Query::serializeVectorToString(const std::vector<Query> &queries, std::string &out) {
-    std::ostringstream oss(std::ios::binary);
-    Query::serializeVectorTo(queries, oss);
-    out = oss.str();
+    out.clear();
+    std::size_t size = sizeof(uint32_t);
+    for (const auto &q : queries) {
+        size += getSerializedSize(q);
+    }
+    detail::utils::serializeAppend(out, size, [&](std::ostream &os) { Query::serializeVectorTo(queries, os); });
 }
 
 std::vector<Query> Query::deserializeVectorFrom(std::istream &is) {
@@ -102,8 +121,14 @@ std::vector<Query> Query::deserializeVectorFrom(std::istream &is) {
 }
 
 std::vector<Query> Query::deserializeVectorFromString(const std::string &data) {
-    std::istringstream iss(data, std::ios::binary);
-    return deserializeVectorFrom(iss);
+    return deserializeVectorFromBuffer(data.data(), data.size());
+}
+
+std::vector<Query> Query::deserializeVectorFromBuffer(const void *data, std::size_t size) {
+    std::vector<Query> queries;
+    detail::utils::deserializeFromBuffer(static_cast<const char *>(data), size,
+                                         [&](std::istream &is) { queries = deserializeVectorFrom(is); });
+    return queries;
 }
 
 } // namespace evi
@@ -0,0 +1,170 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (C) 2025, CryptoLab, Inc.                                       //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//     http://www.apache.org/licenses/LICENSE-2.0                             //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "EVI/impl/QueryCache.hpp"
+
+#include <cstring>
+#include <iterator>
+
+namespace evi {
+namespace detail {
+
+namespace {
+// 64-bit multiply-xorshift hash over the input words; only used to bucket entries, equality is checked on the
+// full key.
+u64 hashBytes(const u8 *data, const std::size_t size) {
+    constexpr u64 mul = 0x9E3779B97F4A7C15ULL;
+    u64 h = size * mul;
+    std::size_t i = 0;
+    for (; i + sizeof(u64) <= size; i += sizeof(u64)) {
+        u64 word;
+        std::memcpy(&word, data + i, sizeof(u64));
+        h = (h ^ word) * mul;
+        h ^= h >> 29;
+    }
+    for (; i < size; ++i) {
+        h = (h ^ data[i]) * mul;
+    }
+    return h ^ (h >> 32);
+}
+
+Query cloneQuery(const Query &query) {
+    Query res;
+    res.reserve(query.size());
+    for (const auto &block : query) {
+        res.push_back(block->clone());
+    }
+    return res;
+}
+} // namespace
+
+bool QueryCache::Key::operator==(const Key &other) const {
+    return hash == other.hash && type == other.type && level == other.level && scale == other.scale &&
+           format == other.format && msg == other.msg;
+}
+
+QueryCache::QueryCache(const std::size_t capacity) : capacity_(capacity) {}
+
+QueryCache::Key QueryCache::makeKey(const utils::InputVector &msg, const EncodeType type, const int level,
+                                    const std::optional<float> scale) {
+    Key key{0, type, level, scale, msg.formatTag(), std::vector<u8>(msg.bytes(), msg.bytes() + msg.byteSize())};
+    u64 params[4] = {static_cast<u64>(type), static_cast<u64>(level), 0, key.format};
+    if (scale.has_value()) {
+        u32 scale_bits;
+        std::memcpy(&scale_bits, &scale.value(), sizeof(scale_bits));
+        params[2] = (U64C(1) << 32) | scale_bits;
+    }
+    key.hash = hashBytes(key.msg.data(), key.msg.size()) ^
+               hashBytes(reinterpret_cast<const u8 *>(params), sizeof(params));
+    return key;
+}
+
+std::list<QueryCache::Entry>::iterator QueryCache::lookup(const Key &key) {
+    auto range = index_.equal_range(key.hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second->first == key) {
+            return it->second;
+        }
+    }
+    return entries_.end();
+}
+
+std::optional<Query> QueryCache::find(const utils::InputVector &msg, const EncodeType type, const int level,
+                                      const std::optional<float> scale) {
+    Key key = makeKey(msg, type, level, scale);
+    std::unique_lock<std::mutex> lock(mtx_);
+    auto it = lookup(key);
+    if (it == entries_.end()) {
+        ++misses_;
+        return std::nullopt;
+    }
+    ++hits_;
+    entries_.splice(entries_.begin(), entries_, it);
+    Query cached = it->second;
+    lock.unlock();
+    // cached blocks are never modified, so they can be copied after the lock is released
+    return cloneQuery(cached);
+}
+
+void QueryCache::insert(const utils::InputVector &msg, const EncodeType type, const int level,
+                        const std::optional<float> scale, const Query &query) {
+    if (!enabled()) {
+        return;
+    }
+    Key key = makeKey(msg, type, level, scale);
+    Query copy = cloneQuery(query);
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (!capacity_) {
+        return;
+    }
+    auto it = lookup(key);
+    if (it != entries_.end()) {
+        it->second = std::move(copy);
+        entries_.splice(entries_.begin(), entries_, it);
+        return;
+    }
+    u64 hash = key.hash;
+    entries_.emplace_front(std::move(key), std::move(copy));
+    index_.emplace(hash, entries_.begin());
+    evictToCapacity();
+}
+
+void QueryCache::evictToCapacity() {
+    while (entries_.size() > capacity_) {
+        auto last = std::prev(entries_.end());
+        auto range = index_.equal_range(last->first.hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == last) {
+                index_.erase(it);
+                break;
+            }
+        }
+        entries_.pop_back();
+        ++evictions_;
+    }
+}
+
+void QueryCache::setCapacity(const std::size_t capacity) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    capacity_ = capacity;
+    evictToCapacity();
+}
+
+QueryCacheStats QueryCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    QueryCacheStats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    stats.size = entries_.size();
+    stats.capacity = capacity_;
+    return stats;
+}
+
+void QueryCache::clear() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    entries_.clear();
+    index_.clear();
+    hits_ = 0;
+    misses_ = 0;
+    evictions_ = 0;
+}
+
+} // namespace detail
+} // namespace evi
@@ -18,6 +18,7 @@
 
 #include "EVI/SearchResult.hpp"
 #include "EVI/impl/CKKSTypes.hpp"
+#include "utils/BufferStream.hpp"
 #include "utils/Utils.hpp"
 
 namespace evi {
@@ -58,4 +59,48 @@ void SearchResult::serializeTo(const SearchResult &res, std::ostream &os) {
     detail::utils::serializeResultTo(*getImpl(res), os);
 }
 
+size_t SearchResult::getSerializedSize(const SearchResult &res) {
+    return detail::utils::getResultSerializedSize(*getImpl(res));
+}
+
+void SearchResult::serializeToBuffer(const SearchResult &res, void *out, size_t size) {
+    detail::utils::serializeToBuffer(static_cast<char *>(out), size, [&](std::ostream &os) { serializeTo(res, os); });
+}
+
+SearchResult SearchResult::deserializeFromBuffer(const void *data, size_t size) {
+    SearchResult res;
+    detail::utils::deserializeFromBuffer(static_cast<const char *>(data), size,
+                                         [&](std::istream &is) { res = deserializeFrom(is); });
+    return res;
+}
+
+void SearchResult::serializeChunkedTo(const SearchResult &res, std::ostream &os, uint32_t ctxts_per_chunk) {
+    detail::utils::serializeResultChunkedTo(*getImpl(res), os, ctxts_per_chunk);
+}
+
+ShardedSearchResult::ShardedSearchResult() : impl_(std::make_shared<detail::ShardedSearchResult>()) {}
+
+void ShardedSearchResult::addShard(const SearchResult &shard, uint64_t item_offset) {
+    impl_->shards.push_back(*getImpl(shard));
+    impl_->item_offsets.push_back(item_offset);
+}
+
+size_t ShardedSearchResult::getShardCount() const {
+    return impl_->shards.size();
+}
+
+const std::shared_ptr<detail::ShardedSearchResult> &getImpl(const ShardedSearchResult &res) noexcept {
+    return res.impl_;
+}
+
+ShardedSearchResult ShardedSearchResult::deserializeFrom(std::istream &is) {
+    ShardedSearchResult res;
+    *res.impl_ = detail::utils::deserializeShardedResultFrom(is);
+    return res;
+}
+
+void ShardedSearchResult::serializeTo(const ShardedSearchResult &res, std::ostream &os) {
+    detail::utils::serializeShardedResultTo(*res.impl_, os);
+}
+
 } // namespace evi
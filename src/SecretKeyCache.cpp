@@ -0,0 +1,181 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (C) 2025, CryptoLab, Inc.                                       //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//     http://www.apache.org/licenses/LICENSE-2.0                             //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "EVI/impl/SecretKeyCache.hpp"
+#include "EVI/impl/Const.hpp"
+#include "utils/Exceptions.hpp"
+
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <sstream>
+#include <streambuf>
+#include <string_view>
+
+namespace evi {
+namespace detail {
+
+namespace {
+// Serialized layout written by SecretKeyData::saveSecKey: loaded flag, preset name, 2-bit packed coefficients.
+constexpr std::size_t KEY_BODY_BYTES = 4 + DEGREE / 4;
+
+// Reads exactly one serialized secret key from in, leaving any trailing data in the stream untouched.
+std::string readKeyBytes(std::istream &in) {
+    std::string bytes(1 + KEY_BODY_BYTES, '\0');
+    if (!in.read(&bytes[0], 1) || !bytes[0]) {
+        throw evi::KeyNotLoadedError("Failed to load to secret key from buffer");
+    }
+    if (!in.read(&bytes[1], KEY_BODY_BYTES)) {
+        secureWipe(&bytes[0], bytes.size());
+        throw evi::KeyNotLoadedError("Failed to load to secret key from buffer");
+    }
+    return bytes;
+}
+
+// Read-only stream over cached bytes, so unpacking does not leave another copy of the key on the heap.
+class ByteStreamBuf : public std::streambuf {
+public:
+    ByteStreamBuf(std::string &bytes) {
+        setg(&bytes[0], &bytes[0], &bytes[0] + bytes.size());
+    }
+};
+
+void wipeSecretKey(SecretKeyData *key) {
+    secureWipe(key->sec_coeff_.data(), DEGREE * sizeof(i64));
+    secureWipe(key->sec_key_q_.data(), U64_DEGREE);
+    secureWipe(key->sec_key_p_.data(), U64_DEGREE);
+    if (key->deb_sk_.coeffs()) {
+        secureWipe(key->deb_sk_.coeffs(), DEGREE);
+    }
+    if (key->deb_sk_[0][0].data()) {
+        secureWipe(key->deb_sk_[0][0].data(), U64_DEGREE);
+    }
+    if (key->deb_sk_[0][1].data()) {
+        secureWipe(key->deb_sk_[0][1].data(), U64_DEGREE);
+    }
+    delete key;
+}
+} // namespace
+
+void secureWipe(void *data, const std::size_t size) {
+    volatile unsigned char *p = static_cast<volatile unsigned char *>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        p[i] = 0;
+    }
+}
+
+SecretKeyCache::SecretKeyCache(const std::size_t capacity) : capacity_(capacity) {}
+
+SecretKeyCache::~SecretKeyCache() {
+    clear();
+}
+
+SecretKey SecretKeyCache::load(const Context &context, const std::string &key_path) {
+    // Same rule as SecretKeyData::loadSecKey: a ".bin" path names a key file, anything else is the key itself.
+    const std::string ext = ".bin";
+    std::string bytes;
+    if (key_path.size() >= ext.size() && key_path.compare(key_path.size() - ext.size(), ext.size(), ext) == 0) {
+        std::ifstream in(key_path, std::ios::in | std::ios_base::binary);
+        if (!in.is_open()) {
+            throw evi::FileNotFoundError("Failed to load secret key");
+        }
+        bytes = readKeyBytes(in);
+    } else {
+        std::istringstream in(key_path, std::ios::binary);
+        bytes = readKeyBytes(in);
+    }
+    return findOrInsert(context, bytes);
+}
+
+SecretKey SecretKeyCache::load(const Context &context, std::istream &key_stream) {
+    std::string bytes = readKeyBytes(key_stream);
+    return findOrInsert(context, bytes);
+}
+
+SecretKey SecretKeyCache::findOrInsert(const Context &context, std::string &bytes) {
+    const std::size_t hash = std::hash<std::string_view>{}(bytes);
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        if (it->hash == hash && it->bytes == bytes) {
+            ++hits_;
+            entries_.splice(entries_.begin(), entries_, it);
+            secureWipe(&bytes[0], bytes.size());
+            return entries_.front().key;
+        }
+    }
+
+    ++misses_;
+    // The deleter wipes the unpacked key once the cache and every in-flight decryption have let go of it.
+    SecretKey key(std::shared_ptr<SecretKeyData>(new SecretKeyData(context), wipeSecretKey));
+    try {
+        ByteStreamBuf buf(bytes);
+        std::istream in(&buf);
+        key->loadSecKey(in);
+    } catch (...) {
+        secureWipe(&bytes[0], bytes.size());
+        throw;
+    }
+    if (!capacity_) {
+        secureWipe(&bytes[0], bytes.size());
+        return key;
+    }
+    entries_.push_front(Entry{hash, std::move(bytes), key});
+    evictToCapacity();
+    return key;
+}
+
+void SecretKeyCache::evictToCapacity() {
+    while (entries_.size() > capacity_) {
+        auto &last = entries_.back();
+        secureWipe(&last.bytes[0], last.bytes.size());
+        entries_.pop_back();
+        ++evictions_;
+    }
+}
+
+void SecretKeyCache::setCapacity(const std::size_t capacity) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    capacity_ = capacity;
+    evictToCapacity();
+}
+
+SecretKeyCache::Stats SecretKeyCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    Stats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    stats.size = entries_.size();
+    stats.capacity = capacity_;
+    return stats;
+}
+
+void SecretKeyCache::clear() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (auto &entry : entries_) {
+        secureWipe(&entry.bytes[0], entry.bytes.size());
+    }
+    entries_.clear();
+    hits_ = 0;
+    misses_ = 0;
+    evictions_ = 0;
+}
+
+} // namespace detail
+} // namespace evi
@@ -0,0 +1,150 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Copyright (C) 2025, CryptoLab, Inc.                                       //
+//                                                                            //
+//  Licensed under the Apache License, Version 2.0 (the "License");           //
+//  you may not use this file except in compliance with the License.          //
+//  You may obtain a copy of the License at                                   //
+//                                                                            //
+//     http://www.apache.org/licenses/LICENSE-2.0                             //
+//                                                                            //
+//  Unless required by applicable law or agreed to in writing, software       //
+//  distributed under the License is distributed on an "AS IS" BASIS,         //
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  //
+//  See the License for the specific language governing permissions and       //
+//  limitations under the License.                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "utils/ThreadPool.hpp"
+#include "EVI/impl/Const.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace evi {
+namespace detail {
+
+namespace {
+thread_local bool in_pool_task = false;
+} // namespace
+
+ThreadPool::ThreadPool(const u32 num_threads) {
+    u32 num_workers = std::min(std::max(num_threads, 1U), MAX_NUM_THREADS) - 1;
+    workers_.reserve(num_workers);
+    for (u32 i = 0; i < num_workers; ++i) {
+        workers_.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+}
+
+ThreadPool &ThreadPool::global() {
+    static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1U));
+    return pool;
+}
+
+void ThreadPool::workerLoop() {
+    in_pool_task = true;
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+            if (stop_ && tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallelFor(const u64 n, const std::function<void(u64)> &fn, const u32 max_threads) {
+    u64 num_threads = std::min<u64>(n, max_threads ? std::min(max_threads, getNumThreads()) : getNumThreads());
+    if (num_threads <= 1 || in_pool_task) {
+        for (u64 i = 0; i < n; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    struct Job {
+        std::atomic<u64> next{0};
+        std::mutex mtx;
+        std::condition_variable done_cv;
+        u64 pending;
+        std::exception_ptr error;
+    };
+    auto job = std::make_shared<Job>();
+    job->pending = num_threads - 1;
+
+    auto run = [job, n, &fn] {
+        for (u64 i = job->next.fetch_add(1); i < n; i = job->next.fetch_add(1)) {
+            try {
+                fn(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(job->mtx);
+                if (!job->error) {
+                    job->error = std::current_exception();
+                }
+                job->next.store(n);
+            }
+        }
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        for (u64 t = 0; t + 1 < num_threads; ++t) {
+            tasks_.emplace_back([job, run] {
+                run();
+                std::lock_guard<std::mutex> lock(job->mtx);
+                if (--job->pending == 0) {
+                    job->done_cv.notify_one();
+                }
+            });
+        }
+    }
+    cv_.notify_all();
+
+    in_pool_task = true;
+    run();
+    in_pool_task = false;
+
+    std::unique_lock<std::mutex> lock(job->mtx);
+    job->done_cv.wait(lock, [&job] { return job->pending == 0; });
+    if (job->error) {
+        std::rethrow_exception(job->error);
+    }
+}
+
+std::future<void> ThreadPool::submit(std::function<void()> fn) {
+    auto task = std::make_shared<std::packaged_task<void()>>(std::move(fn));
+    std::future<void> res = task->get_future();
+    if (workers_.empty() || in_pool_task) {
+        (*task)();
+        return res;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        tasks_.emplace_back([task] { (*task)(); });
+    }
+    cv_.notify_one();
+    return res;
+}
+
+} // namespace detail
+} // namespace evi
@@ -80,11 +80,13 @@ std::vector<uint8_t> utils::decodeBase64(const std::string &encoded) {
 }
 
 void utils::serializeQueryTo(const Query &query, std::ostream &os) {
-    QueryType query_type = QueryType::SINGLE;
+    // Only packed queries carry an item count, so other queries keep the plain SINGLE layout.
+    u32 packed_count = query.getInnerItemCount();
+    QueryType query_type = packed_count ? QueryType::PACKED_SINGLE : QueryType::SINGLE;
     uint8_t query_type_raw = static_cast<uint8_t>(query_type);
     os.write(reinterpret_cast<const char *>(&query_type_raw), sizeof(query_type_raw));
-    if (query_type_raw != static_cast<uint8_t>(QueryType::SINGLE)) {
-        throw NotSupportedError("Matrix-based Query serialization requires BUILD_WITH_HEM");
+    if (query_type == QueryType::PACKED_SINGLE) {
+        os.write(reinterpret_cast<const char *>(&packed_count), sizeof(packed_count));
     }
 
     if (query.empty()) {
@@ -99,11 +101,29 @@ void utils::serializeQueryTo(const Query &query, std::ostream &os) {
     }
 }
 
+u64 utils::getQuerySerializedSize(const Query &query) {
+    if (query.empty()) {
+        throw InvalidInputError("Cannot serialize empty single-query container");
+    }
+    // query type, [packed item count,] data type and block count
+    u64 size = sizeof(uint8_t) + (query.getInnerItemCount() ? sizeof(u32) : 0) + 1 + sizeof(u32);
+    for (const auto &block : query) {
+        size += block->getSerializedSize();
+    }
+    return size;
+}
+
 Query utils::deserializeQueryFrom(std::istream &is) {
     uint8_t query_type_raw = 0;
     is.read(reinterpret_cast<char *>(&query_type_raw), sizeof(query_type_raw));
 
-    if (query_type_raw != static_cast<uint8_t>(QueryType::SINGLE)) {
+    u32 packed_count = 0;
+    if (query_type_raw == static_cast<uint8_t>(QueryType::PACKED_SINGLE)) {
+        is.read(reinterpret_cast<char *>(&packed_count), sizeof(packed_count));
+        if (!packed_count || packed_count > DEGREE) {
+            throw InvalidInputError("Invalid item count for packed query deserialization");
+        }
+    } else if (query_type_raw != static_cast<uint8_t>(QueryType::SINGLE)) {
         throw NotSupportedError("Matrix-based Query deserialization is not supported current mode");
     }
 
@@ -124,10 +144,17 @@ Query utils::deserializeQueryFrom(std::istream &is) {
         }
         break;
     case DataType::SERIALIZED_PLAIN:
-        throw NotSupportedError("To be updated after shared-a feature done");
+        for (u32 i = 0; i < size; i++) {
+            res.emplace_back(std::make_shared<SerializedSingleQuery<DataType::PLAIN>>(is));
+        }
+        break;
     default:
         throw NotSupportedError("Invalid type for query deserialization");
     }
+    if (packed_count) {
+        res.setInnerItemCount(packed_count);
+        res.setItemCount(packed_count);
+    }
     return res;
 }
 
@@ -148,6 +175,14 @@ void utils::serializeResultTo(const SearchResult &res, std::ostream &os) {
     }
 }
 
+u64 utils::getResultSerializedSize(const SearchResult &res) {
+    if (res->ip_data == nullptr) {
+        throw NotSupportedError("Invalid type for result serialization");
+    }
+    // tag and total item count
+    return sizeof(uint8_t) + sizeof(u32) + res->ip_data->getSerializedSize();
+}
+
 SearchResult utils::deserializeResultFrom(std::istream &is) {
     uint8_t tag = 0;
     is.read(reinterpret_cast<char *>(&tag), sizeof(tag));
@@ -164,6 +199,26 @@ SearchResult utils::deserializeResultFrom(std::istream &is) {
         if (!total_count && res->ip_data != nullptr) {
             total_count = static_cast<u32>(res->ip_data->n);
         }
+    } else if (tag == RESULT_TAG_CHUNKED) {
+        ResultChunkHeader header = readResultChunkHeader(is);
+        auto matrix = std::make_shared<Matrix<DataType::CIPHER>>(header.level);
+        matrix->setSize(static_cast<int>(header.num_ctxt * DEGREE));
+        auto chunk = std::make_shared<Matrix<DataType::CIPHER>>(header.level);
+        for (u64 first = 0; first < header.num_ctxt; first += header.ctxts_per_chunk) {
+            const u64 count = std::min(header.ctxts_per_chunk, header.num_ctxt - first);
+            readResultChunk(is, *chunk, count);
+            for (int pos = 0; pos < 2; ++pos) {
+                for (int level = 0; level <= header.level; ++level) {
+                    std::copy_n(chunk->getPolyData(pos, level), count * DEGREE,
+                                matrix->getPolyData(pos, level) + first * DEGREE);
+                }
+            }
+        }
+        matrix->n = header.n;
+        matrix->dim = header.dim;
+        matrix->degree = header.degree;
+        res = SearchResult(std::make_shared<IPSearchResult>());
+        res->ip_data = matrix;
     } else {
         throw std::runtime_error("Unknown result type tag");
     }
@@ -171,6 +226,169 @@ SearchResult utils::deserializeResultFrom(std::istream &is) {
     return res;
 }
 
+void utils::serializeResultChunkedTo(const SearchResult &res, std::ostream &os, const u64 ctxts_per_chunk) {
+    if (res->ip_data == nullptr) {
+        throw NotSupportedError("Invalid type for result serialization");
+    }
+    if (!ctxts_per_chunk) {
+        throw InvalidInputError("A result chunk must hold at least one ciphertext");
+    }
+    IData &data = *res->ip_data;
+    ResultChunkHeader header{data.getLevel(), data.n, data.dim, data.degree, data.getPoly(0, 0).size() / DEGREE,
+                             ctxts_per_chunk};
+    u32 total_count = res.getTotalItemCount();
+    if (!total_count) {
+        total_count = static_cast<u32>(data.n);
+    }
+    os.write(reinterpret_cast<const char *>(&RESULT_TAG_CHUNKED), sizeof(RESULT_TAG_CHUNKED));
+    os.write(reinterpret_cast<const char *>(&total_count), sizeof(total_count));
+    os.write(reinterpret_cast<const char *>(&header.level), sizeof(header.level));
+    os.write(reinterpret_cast<const char *>(&header.n), sizeof(header.n));
+    os.write(reinterpret_cast<const char *>(&header.dim), sizeof(header.dim));
+    os.write(reinterpret_cast<const char *>(&header.degree), sizeof(header.degree));
+    os.write(reinterpret_cast<const char *>(&header.num_ctxt), sizeof(header.num_ctxt));
+    os.write(reinterpret_cast<const char *>(&header.ctxts_per_chunk), sizeof(header.ctxts_per_chunk));
+
+    for (u64 first = 0; first < header.num_ctxt; first += ctxts_per_chunk) {
+        const u64 count = std::min(ctxts_per_chunk, header.num_ctxt - first);
+        for (int level = 0; level <= header.level; ++level) {
+            for (int pos : {1, 0}) {
+                os.write(reinterpret_cast<const char *>(data.getPolyData(pos, level) + first * DEGREE),
+                         count * U64_DEGREE);
+            }
+        }
+    }
+}
+
+utils::ResultChunkHeader utils::readResultChunkHeader(std::istream &is) {
+    ResultChunkHeader header;
+    is.read(reinterpret_cast<char *>(&header.level), sizeof(header.level));
+    is.read(reinterpret_cast<char *>(&header.n), sizeof(header.n));
+    is.read(reinterpret_cast<char *>(&header.dim), sizeof(header.dim));
+    is.read(reinterpret_cast<char *>(&header.degree), sizeof(header.degree));
+    is.read(reinterpret_cast<char *>(&header.num_ctxt), sizeof(header.num_ctxt));
+    is.read(reinterpret_cast<char *>(&header.ctxts_per_chunk), sizeof(header.ctxts_per_chunk));
+    if (!is || !header.ctxts_per_chunk || (header.level != 0 && header.level != 1) ||
+        header.num_ctxt > MAX_RESULT_CTXTS) {
+        throw InvalidInputError("Invalid chunked search result header");
+    }
+    return header;
+}
+
+void utils::readResultChunk(std::istream &is, IData &chunk, const u64 num_ctxt) {
+    if (num_ctxt > MAX_RESULT_CTXTS) {
+        throw InvalidInputError("Too many ciphertexts in a search result chunk");
+    }
+    chunk.setSize(static_cast<int>(num_ctxt * DEGREE));
+    for (int level = 0; level <= chunk.getLevel(); ++level) {
+        for (int pos : {1, 0}) {
+            is.read(reinterpret_cast<char *>(chunk.getPolyData(pos, level)), num_ctxt * U64_DEGREE);
+        }
+    }
+    if (!is) {
+        throw InvalidInputError("Truncated chunked search result");
+    }
+}
+
+utils::ResultChunkHeader utils::readResultPlanarHeader(std::istream &is) {
+    ResultChunkHeader header{};
+    is.read(reinterpret_cast<char *>(&header.level), sizeof(header.level));
+    is.read(reinterpret_cast<char *>(&header.n), sizeof(header.n));
+    is.read(reinterpret_cast<char *>(&header.dim), sizeof(header.dim));
+    is.read(reinterpret_cast<char *>(&header.degree), sizeof(header.degree));
+    if (!is || header.degree != DEGREE || (header.level != 0 && header.level != 1) ||
+        header.n > MAX_RESULT_CTXTS * DEGREE) {
+        throw InvalidInputError("Invalid search result header");
+    }
+    header.num_ctxt = (header.n + header.degree - 1) / header.degree;
+    return header;
+}
+
+void utils::readPlanarResultChunk(std::istream &is, const std::streampos base, const ResultChunkHeader &header,
+                                  IData &chunk, const u64 first, const u64 num_ctxt) {
+    if (first > header.num_ctxt || num_ctxt > header.num_ctxt - first) {
+        throw InvalidInputError("Search result chunk is out of range");
+    }
+    chunk.setSize(static_cast<int>(num_ctxt * DEGREE));
+    const std::streamoff plane_bytes = static_cast<std::streamoff>(header.num_ctxt * U64_DEGREE);
+    std::streamoff plane = 0;
+    for (int level = 0; level <= header.level; ++level) {
+        for (int pos : {1, 0}) {
+            is.seekg(base + plane * plane_bytes + static_cast<std::streamoff>(first * U64_DEGREE));
+            is.read(reinterpret_cast<char *>(chunk.getPolyData(pos, level)), num_ctxt * U64_DEGREE);
+            ++plane;
+        }
+    }
+    if (!is) {
+        throw InvalidInputError("Truncated search result");
+    }
+}
+
+void utils::serializeShardedResultTo(const ShardedSearchResult &res, std::ostream &os) {
+    if (res.shards.size() != res.item_offsets.size()) {
+        throw InvalidInputError("Every shard needs an item offset");
+    }
+    const u32 num_shards = static_cast<u32>(res.shards.size());
+    os.write(reinterpret_cast<const char *>(&num_shards), sizeof(num_shards));
+    for (u32 i = 0; i < num_shards; ++i) {
+        os.write(reinterpret_cast<const char *>(&res.item_offsets[i]), sizeof(res.item_offsets[i]));
+        serializeResultTo(res.shards[i], os);
+    }
+}
+
+ShardedSearchResult utils::deserializeShardedResultFrom(std::istream &is) {
+    u32 num_shards = 0;
+    is.read(reinterpret_cast<char *>(&num_shards), sizeof(num_shards));
+    if (!is) {
+        throw InvalidInputError("Truncated sharded search result");
+    }
+    ShardedSearchResult res;
+    for (u32 i = 0; i < num_shards; ++i) {
+        u64 item_offset = 0;
+        is.read(reinterpret_cast<char *>(&item_offset), sizeof(item_offset));
+        if (!is) {
+            throw InvalidInputError("Truncated sharded search result");
+        }
+        res.item_offsets.push_back(item_offset);
+        res.shards.push_back(deserializeResultFrom(is));
+    }
+    validateShardedResult(res);
+    return res;
+}
+
+u64 utils::getResultItemCount(const SearchResult &res) {
+    const u64 capacity = (res->ip_data->getPoly(0, 0).size() + DEGREE - 1) / DEGREE * DEGREE;
+    return res.getTotalItemCount() ? std::min<u64>(res.getTotalItemCount(), capacity) : capacity;
+}
+
+void utils::validateShardedResult(const ShardedSearchResult &res) {
+    if (res.shards.size() != res.item_offsets.size()) {
+        throw InvalidInputError("Every shard needs an item offset");
+    }
+    std::vector<std::pair<u64, u64>> ranges;
+    ranges.reserve(res.shards.size());
+    for (u64 i = 0; i < res.shards.size(); ++i) {
+        const u64 count = getResultItemCount(res.shards[i]);
+        if (res.item_offsets[i] > std::numeric_limits<u64>::max() - count) {
+            throw InvalidInputError("Shard item range overflows");
+        }
+        ranges.emplace_back(res.item_offsets[i], res.item_offsets[i] + count);
+    }
+    // Together the shards must number items 0, 1, ... without holes, so that the decrypted score vector is sized by
+    // the items actually present rather than by offsets taken from the wire.
+    std::sort(ranges.begin(), ranges.end());
+    u64 next = 0;
+    for (const auto &range : ranges) {
+        if (range.first < next) {
+            throw InvalidInputError("Shard item ranges overlap");
+        }
+        if (range.first > next) {
+            throw InvalidInputError("Shard item ranges leave a gap");
+        }
+        next = range.second;
+    }
+}
+
 SealMode utils::stringToSealMode(const std::string &str) {
     if (str == "NONE") {
         return SealMode::NONE;
@@ -18,18 +18,27 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <memory>
+#include <numeric>
 #include <random>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
 
 #include "EVI/Const.hpp"
 #include "EVI/impl/DecryptorImpl.hpp"
 #include "EVI/impl/EncryptorImpl.hpp"
+#include "EVI/impl/ItemPackerImpl.hpp"
 #include "EVI/impl/KeyGeneratorImpl.hpp"
 #include "utils.hpp"
+#include "utils/BufferStream.hpp"
 #include "utils/SealInfo.hpp"
+#include "utils/ThreadPool.hpp"
 #include "utils/Utils.hpp"
 
 using namespace evi::detail;
@@ -74,6 +83,31 @@ protected:
     static std::string test_pcmm_key_path;
 };
 
+// Concatenates the level-0 ciphertexts of single-block queries into one search result, one ciphertext each.
+static SearchResult makeSearchResult(const std::vector<Query> &queries) {
+    polyvec a_q, b_q;
+    for (const auto &query : queries) {
+        a_q.insert(a_q.end(), query[0]->getPolyData(1, 0), query[0]->getPolyData(1, 0) + DEGREE);
+        b_q.insert(b_q.end(), query[0]->getPolyData(0, 0), query[0]->getPolyData(0, 0) + DEGREE);
+    }
+    SearchResult res;
+    res->ip_data = std::make_shared<Matrix<evi::DataType::CIPHER>>(std::move(a_q), std::move(b_q));
+    return res;
+}
+
+// A string-backed buffer that refuses to seek, like a socket or pipe would.
+struct NoSeekStreamBuf : std::stringbuf {
+    explicit NoSeekStreamBuf(const std::string &data) : std::stringbuf(data, std::ios::in | std::ios::binary) {}
+
+protected:
+    pos_type seekoff(off_type, std::ios::seekdir, std::ios::openmode) override {
+        return pos_type(off_type(-1));
+    }
+    pos_type seekpos(pos_type, std::ios::openmode) override {
+        return pos_type(off_type(-1));
+    }
+};
+
 u32 EnDecryptTest::rank = 0;
 evi::ParameterPreset EnDecryptTest::preset;
 double EnDecryptTest::db_scale = 0.0;
@@ -107,6 +141,71 @@ TEST_F(EnDecryptTest, BaseQueryEncDecTest) {
     EXPECT_LE(maxError(dmsg, msg), MAX_ERROR);
 }
 
+TEST_F(EnDecryptTest, LevelEncDecTest) {
+    Context context = makeContext(preset, device_type, rank, evi::EvalMode::FLAT);
+    KeyPack pack = makeKeyPack(context);
+    KeyGenerator keygen = makeKeyGenerator(context, pack);
+
+    auto sec_key = keygen->genSecKey();
+    keygen->genPubKeys(sec_key);
+
+    Encryptor enc = makeEncryptor(context, pack);
+    Decryptor dec = makeDecryptor(context);
+
+    std::vector<float> msg(rank, 0);
+    randomFaces(msg.data(), -1, 1, 1, rank);
+
+    for (bool level : {false, true}) {
+        auto query = enc->encrypt(evi::span<float>(msg), pack, evi::EncodeType::ITEM, level, std::nullopt);
+        ASSERT_EQ(query[0]->getLevel(), level ? 1 : 0);
+        EXPECT_LE(maxError(msg, dec->decrypt(query, sec_key)), MAX_ERROR);
+
+        query = enc->encrypt(evi::span<float>(msg), sec_key, evi::EncodeType::QUERY, level, std::nullopt);
+        ASSERT_EQ(query[0]->getLevel(), level ? 1 : 0);
+        EXPECT_LE(maxError(msg, dec->decrypt(query, sec_key)), MAX_ERROR);
+    }
+}
+
+TEST_F(EnDecryptTest, WideEncodeFallbackTest) {
+    Context context = makeContext(preset, device_type, rank, evi::EvalMode::FLAT);
+    Encryptor enc = makeEncryptor(context);
+
+    // One coefficient that overflows an i64 sends the whole block through the 128-bit reduction; every other
+    // coefficient must come out exactly as the 64-bit path encodes it.
+    const float scale = 0x1p40f;
+    const u64 big_idx = rank / 2;
+    std::vector<float> narrow(rank, 0);
+    randomFaces(narrow.data(), -1, 1, 1, rank);
+    narrow[big_idx] = 0.0f;
+    std::vector<float> wide = narrow;
+    wide[big_idx] = 0x1p24f;
+
+    for (bool level : {false, true}) {
+        auto narrow_query = enc->encode(narrow, evi::EncodeType::ITEM, level, scale);
+        auto wide_query = enc->encode(wide, evi::EncodeType::ITEM, level, scale);
+        for (int l = 0; l <= (level ? 1 : 0); ++l) {
+            const u64 prime = l ? context->getParam()->getPrimeP() : context->getParam()->getPrimeQ();
+            poly narrow_coeffs, wide_coeffs;
+            std::memcpy(narrow_coeffs.data(), narrow_query[0]->getPolyData(0, l), U64_DEGREE);
+            std::memcpy(wide_coeffs.data(), wide_query[0]->getPolyData(0, l), U64_DEGREE);
+            if (l) {
+                context->inttModP(narrow_coeffs);
+                context->inttModP(wide_coeffs);
+            } else {
+                context->inttModQ(narrow_coeffs);
+                context->inttModQ(wide_coeffs);
+            }
+            for (u64 i = 0; i < DEGREE; ++i) {
+                if (i == big_idx) {
+                    EXPECT_EQ(wide_coeffs[i], static_cast<u64>((static_cast<u128>(1) << 64) % prime));
+                } else {
+                    ASSERT_EQ(wide_coeffs[i], narrow_coeffs[i]) << "level " << l << ", coefficient " << i;
+                }
+            }
+        }
+    }
+}
+
 TEST_F(EnDecryptTest, RMPQueryEncDecTest) {
     Context context = makeContext(preset, device_type, rank, evi::EvalMode::RMP);
     KeyPack pack = makeKeyPack(context);
@@ -164,6 +263,99 @@ TEST_F(EnDecryptTest, RMPBulkEncDecTest) {
     }
 }
 
+TEST_F(EnDecryptTest, RMPParallelEncryptTest) {
+    if (ThreadPool::global().getNumThreads() < 2) {
+        GTEST_SKIP() << "the parallel path needs at least two pool threads";
+    }
+    Context context = makeContext(preset, device_type, rank, evi::EvalMode::RMP);
+    KeyPack pack = makeKeyPack(context);
+    KeyGenerator keygen = makeKeyGenerator(context, pack);
+
+    auto sec_key = keygen->genSecKey();
+    keygen->genPubKeys(sec_key);
+
+    // A seeded encryptor always encrypts its ciphertexts in order on one encryptor; the unseeded one spreads them
+    // over the pool with one leased encryptor per worker.
+    Encryptor parallel_enc = makeEncryptor(context, pack);
+    Encryptor serial_enc = makeEncryptor(context, pack, std::vector<u8>(sizeof(deb::RNGSeed), 7));
+    Decryptor dec = makeDecryptor(context);
+
+    std::vector<float> msg(4 * DEGREE, 0);
+    randomFaces(msg.data(), -1, 1, 4, DEGREE);
+
+    for (auto type : {evi::EncodeType::ITEM, evi::EncodeType::QUERY}) {
+        auto parallel = parallel_enc->encrypt(msg, type);
+        auto serial = serial_enc->encrypt(msg, type);
+        ASSERT_GT(parallel.size(), 1u);
+        ASSERT_EQ(parallel.size(), serial.size());
+
+        Message parallel_msg = dec->decrypt(parallel, sec_key);
+        Message serial_msg = dec->decrypt(serial, sec_key);
+        ASSERT_EQ(parallel_msg.size(), serial_msg.size());
+        EXPECT_LE(maxError(serial_msg, parallel_msg), 2 * MAX_ERROR);
+        EXPECT_LE(maxError(msg, parallel_msg), MAX_ERROR);
+    }
+}
+
+TEST_F(EnDecryptTest, RMPIndexedDecryptReuseTest) {
+    Context context = makeContext(preset, device_type, rank, evi::EvalMode::RMP);
+    KeyPack pack = makeKeyPack(context);
+    KeyGenerator keygen = makeKeyGenerator(context, pack);
+
+    auto sec_key = keygen->genSecKey();
+    keygen->genPubKeys(sec_key);
+
+    Encryptor enc = makeEncryptor(context, pack);
+    Decryptor dec = makeDecryptor(context);
+
+    std::vector<std::vector<float>> msg_a(2, std::vector<float>(DEGREE, 0));
+    std::vector<std::vector<float>> msg_b(2, std::vector<float>(DEGREE, 0));
+    for (int i = 0; i < 2; ++i) {
+        randomFaces(msg_a[i].data(), -1, 1, 1, rank);
+        randomFaces(msg_b[i].data(), -1, 1, 1, rank);
+    }
+    auto query_a = enc->encrypt(msg_a, evi::EncodeType::ITEM);
+    auto query_b = enc->encrypt(msg_b, evi::EncodeType::ITEM);
+
+    EXPECT_LE(maxError(msg_a[0], dec->decrypt(0, query_a[0], sec_key)), MAX_ERROR);
+    EXPECT_LE(maxError(msg_a[1], dec->decrypt(1, query_a[0], sec_key)), MAX_ERROR);
+    EXPECT_THROW(dec->decrypt(2, query_a[0], sec_key), evi::InvalidInputError);
+
+    auto items = dec->decryptItems(query_a[0], sec_key);
+    ASSERT_EQ(items.size(), 2u);
+    for (int i = 0; i < 2; ++i) {
+        EXPECT_EQ(items[i], dec->decrypt(i, query_a[0], sec_key));
+        EXPECT_LE(maxError(msg_a[i], items[i]), MAX_ERROR);
+    }
+    EXPECT_THROW(dec->decrypt(-1, query_a[0], sec_key), evi::InvalidInputError);
+
+    // selected items come back in the requested order
+    auto selected = dec->decryptItems(query_a[0], sec_key, std::vector<uint64_t>{1, 0, 1});
+    ASSERT_EQ(selected.size(), 3u);
+    EXPECT_EQ(selected[0], items[1]);
+    EXPECT_EQ(selected[1], items[0]);
+    EXPECT_EQ(selected[2], items[1]);
+    EXPECT_THROW(dec->decryptItems(query_a[0], sec_key, std::vector<uint64_t>{0, 2}), evi::InvalidInputError);
+
+    // a QUERY-encoded ciphertext holds a single item, so any other index is out of range
+    auto single = enc->encrypt(msg_a[0], evi::EncodeType::QUERY);
+    EXPECT_LE(maxError(msg_a[0], dec->decrypt(0, single, sec_key)), MAX_ERROR);
+    EXPECT_THROW(dec->decrypt(1, single, sec_key), evi::InvalidInputError);
+    EXPECT_EQ(dec->decryptItems(single, sec_key).size(), 1u);
+    EXPECT_THROW(dec->decryptItems(single, sec_key, std::vector<uint64_t>{1}), evi::InvalidInputError);
+
+    // overwriting the ciphertext in place must not serve the coefficients decrypted before
+    for (int i = 0; i < query_a[0].size(); ++i) {
+        for (int level = 0; level <= query_a[0][i]->getLevel(); ++level) {
+            for (int pos = 0; pos < 2; ++pos) {
+                std::copy_n(query_b[0][i]->getPoly(pos, level).data(), DEGREE,
+                            query_a[0][i]->getPoly(pos, level).data());
+            }
+        }
+    }
+    EXPECT_LE(maxError(msg_b[1], dec->decrypt(1, query_a[0], sec_key)), MAX_ERROR);
+}
+
 TEST_F(EnDecryptTest, StreamKeyEncDecTest) {
     Context context = makeContext(preset, device_type, rank, evi::EvalMode::FLAT);
     KeyPack pack = makeKeyPack(context);
@@ -199,6 +391,944 @@ TEST_F(EnDecryptTest, StreamKeyEncDecTest) {
     EXPECT_LE(maxError(dmsg2, msg), MAX_ERROR);
 }
 
+TEST_F(EnDecryptTest, SecretKeyCacheDecryptTest) {
+    Context context = makeContext(preset, device_type, rank, evi::EvalMode::FLAT);
+    KeyPack pack = makeKeyPack(context);
+    KeyGenerator keygen = makeKeyGenerator(context, pack);
+
+    std::vector<float> msg(rank, 0);
+    randomFaces(msg.data(), -1, 1, 1, rank);
+
+    // two independent keys, each with a query encrypted under it
+    std::vector<std::string> sec_blobs;
+    std::vector<Query> queries;
+    for (int k = 0; k < 2; ++k) {
+        auto sec_key = keygen->genSecKey();
+        keygen->genPubKeys(sec_key);
+        Encryptor enc = makeEncryptor(context, pack);
+        queries.push_back(enc->encrypt(msg, evi::EncodeType::ITEM));
+
+        std::ostringstream sec_key_buffer(std::ios::binary | std::ios::out);
+        sec_key->saveSecKey(sec_key_buffer);
+        sec_blobs.push_back(sec_key_buffer.str());
+    }
+
+    Decryptor dec = makeDecryptor(context);
+    dec->setSecretKeyCacheCapacity(1);
+    for (int k : {0, 0, 1, 0}) {
+        std::istringstream sec_stream(sec_blobs[k], std::ios::binary | std::ios::in);
+        EXPECT_LE(maxError(msg, dec->decrypt(queries[k], sec_stream)), MAX_ERROR);
+    }
+
+    // only the second load of key 0 is a hit; with room for one key, each switch evicts the other
+    auto stats = dec->getSecretKeyCacheStats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 3u);
+    EXPECT_EQ(stats.evictions, 2u);
+    EXPECT_EQ(stats.size, 1u);
+
+    dec->setSecretKeyCacheCapacity(0);
+    std::istringstream sec_stream(sec_blobs[1], std::ios::binary | std::ios::in);
+    EXPECT_LE(maxError(msg, dec->decrypt(queries[1], sec_stream)), MAX_ERROR);
+    stats = dec->getSecretKeyCacheStats();
+    EXPECT_EQ(stats.capacity, 0u);
+    EXPECT_EQ(stats.size, 0u);
+    EXPECT_EQ(stats.misses, 0u);
+}
+
+TEST_F(EnDecryptTest, ConcurrentDecryptTest) {
+    Context context = makeContext(preset, device_type, rank, evi::EvalMode::FLAT);
+    KeyPack pack = makeKeyPack(context);
+    KeyGenerator keygen = makeKeyGenerator(context, pack);
+
+    auto sec_key = keygen->genSecKey();
+    keygen->genPubKeys(sec_key);
+
+    Encryptor enc = makeEncryptor(context, pack);
+    Decryptor dec = makeDecryptor(context);
+    dec->setNumThreads(2);
+
+    const u64 num_callers = 4;
+    std::vector<std::vector<std::vector<float>>> msgs(num_callers);
+    std::vector<SearchResult> results;
+    std::vector<Query> singles;
+    for (auto &caller_msgs : msgs) {
+        std::vector<Query> queries;
+        for (u64 c = 0; c < 5; ++c) {
+            caller_msgs.emplace_back(DEGREE, 0.0f);
+            randomFaces(caller_msgs.back().data(), -1, 1, 1, DEGREE);
+            queries.push_back(enc->encrypt(caller_msgs.back(), evi::EncodeType::ITEM));
+        }
+        results.push_back(makeSearchResult(queries));
+        singles.push_back(queries[0]);
+    }
+
+    // Every caller shares one decryptor; each must still get back exactly its own messages.
+    std::vector<Message> decrypted(num_callers), single_decrypted(num_callers);
+    std::vector<std::thread> callers;
+    for (u64 t = 0; t < num_callers; ++t) {
+        callers.emplace_back([&, t]() {
+            for (int rep = 0; rep < 3; ++rep) {
+                decrypted[t] = dec->decrypt(results[t], sec_key, false);
+                single_decrypted[t] = dec->decrypt(singles[t], sec_key);
+            }
+        });
+    }
+    for (auto &caller : callers) {
+        caller.join();
+    }
+
+    for (u64 t = 0; t < num_callers; ++t) {
+        ASSERT_EQ(decrypted[t].size(), msgs[t].size() * DEGREE);
+        for (u64 c = 0; c < msgs[t].size(); ++c) {
+            EXPECT_LE(maxError(msgs[t][c], evi::span<float>(decrypted[t].data() + c * DEGREE, DEGREE)), MAX_ERROR);
+        }
+        EXPECT_LE(maxError(msgs[t][0], single_decrypted[t]), MAX_ERROR);
+    }
+}
+
+TEST_F(EnDecryptTest, ParallelSearchResultDecryptTest) {
+    Context context = makeContext(preset, device_type, rank, evi::EvalMode::FLAT);
+    KeyPack pack = makeKeyPack(context);
+    KeyGenerator keygen = makeKeyGenerator(context, pack);
+
+    auto sec_key = keygen->genSecKey();
+    keygen->genPubKeys(sec_key);
+
+    Encryptor enc = makeEncryptor(context, pack);
+    Decryptor dec = makeDecryptor(context);
+
+    std::vector<std::vector<float>> msgs(9, std::vector<float>(DEGREE, 0));
+    std::vector<Query> queries;
+    for (auto &msg : msgs) {
+        randomFaces(msg.data(), -1, 1, 1, DEGREE);
+        queries.push_back(enc->encrypt(msg, evi::EncodeType::ITEM));
+    }
+    SearchResult result = makeSearchResult(queries);
+
+    dec->setNumThreads(1);
+    Message sequential = dec->decrypt(result, sec_key, false);
+    dec->setNumThreads(4);
+    Message parallel = dec->decrypt(result, sec_key, false);
+
+    ASSERT_EQ(sequential.size(), msgs.size() * DEGREE);
+    EXPECT_EQ(sequential, parallel);
+    for (u64 c = 0; c < msgs.size(); ++c) {
+        Message chunk(parallel.begin() + c * DEGREE, parallel.begin() + (c + 1) * DEGREE);
+        EXPECT_LE(maxError(msgs[c], chunk), MAX_ERROR);
+    }
+}
+
+TEST_F(EnDecryptTest, ScoreSlotPermutationTest) {
+    Context context = makeContext(preset, device_type, rank, evi::EvalMode::FLAT);
+    KeyPack pack = makeKeyPack(context);
+    KeyGenerator keygen = makeKeyGenerator(context, pack);
+
+    auto sec_key = keygen->genSecKey();
+    keygen->genPubKeys(sec_key);
+
+    Encryptor enc = makeEncryptor(context, pack);
+    Decryptor dec = makeDecryptor(context);
+
+    std::vector<std::vector<float>> msgs(2, std::vector<float>(DEGREE, 0));
+    std::vector<Query> queries;
+    for (auto &msg : msgs) {
+        randomFaces(msg.data(), -1, 1, 1, DEGREE);
+        queries.push_back(enc->encrypt(msg, evi::EncodeType::ITEM));
+    }
+    SearchResult result = makeSearchResult(queries);
+
+    // Decrypted at the message scale, score j must be coefficient (j % items) * pad_rank + j / items.
+    const double delta = std::pow(2.0, context->getParam()->getScaleFactor());
+    Message raw = dec->decrypt(result, sec_key, false, delta);
+    Message scores = dec->decrypt(result, sec_key, true, delta);
+    ASSERT_EQ(raw.size(), msgs.size() * DEGREE);
+    ASSERT_EQ(scores.size(), raw.size());
+
+    const u64 items = context->getItemsPerCtxt();
+    const u64 pad_rank = context->getPadRank();
+    for (u64 c = 0; c < msgs.size(); ++c) {
+        for (u64 j = 0; j < DEGREE; ++j) {
+            const u64 coeff = (j % items) * pad_rank + j / items;
+            ASSERT_EQ(scores[c * DEGREE + j], raw[c * DEGREE + coeff]) << "ctxt " << c << ", score " << j;
+            ASSERT_NEAR(scores[c * DEGREE + j], msgs[c][coeff], MAX_ERROR);
+        }
+    }
+}
+
+TEST_F(EnDecryptTest, DecryptViewReuseTest) {
+    Context context = makeContext(preset, device_type, rank, evi::EvalMode::FLAT);
+    KeyPack pack = makeKeyPack(context);
+    KeyGenerator keygen = makeKeyGenerator(context, pack);
+
+    auto sec_key = keygen->genSecKey();
+    keygen->genPubKeys(sec_key);
+
+    Encryptor enc = makeEncryptor(context, pack);
+    Decryptor dec = makeDecryptor(context);
+    // A single worker, so every decryption below rebinds the same level-0 and level-1 views.
+    dec->setNumThreads(1);
+
+    std::vector<std::vector<float>> msgs(3, std::vector<float>(rank, 0));
+    std::vector<Query> queries;
+    for (u64 i = 0; i < msgs.size(); ++i) {
+        randomFaces(msgs[i].data(), -1, 1, 1, rank);
+        queries.push_back(enc->encrypt(evi::span<float>(msgs[i]), pack, evi::EncodeType::ITEM, i == 1, std::nullopt));
+    }
+
+    for (u64 i : {0, 1, 2, 1, 0, 2}) {
+        EXPECT_LE(maxError(msgs[i], dec->decrypt(queries[i], sec_key)), MAX_ERROR) << "query " << i;
+    }
+
+    std::vector<std::vector<float>> faces(3, std::vector<float>(DEGREE, 0));
+    std::vector<Query> result_queries;
+    for (auto &face : faces) {
+        randomFaces(face.data(), -1, 1, 1, DEGREE);
+        result_queries.push_back(enc->encrypt(face, evi::EncodeType::ITEM));
+    }
+    SearchResult result = makeSearchResult(result_queries);
+    Message first = dec->decrypt(result, sec_key, false);
+    EXPECT_LE(maxError(msgs[1], dec->decrypt(queries[1], sec_key)), MAX_ERROR);
+    Message second = dec->decrypt(result, sec_key, false);
+    EXPECT_EQ(first, second);
+    for (u64 c = 0; c < faces.size(); ++c) {
+        EXPECT_LE(maxError(faces[c], evi::span<float>(first.data() + c * DEGREE, DEGREE)), MAX_ERROR);
+    }
+}
+
+TEST_F(EnDecryptTest, SearchResultDecryptToTest) {
+    Context context = makeContext(preset, device_type, rank, evi::EvalMode::FLAT);
+    KeyPack pack = makeKeyPack(context);
+    KeyGenerator keygen = makeKeyGenerator(context, pack);
+
+    auto sec_key = keygen->genSecKey();
+    keygen->genPubKeys(sec_key);
+
+    Encryptor enc = makeEncryptor(context, pack);
+    Decryptor dec = makeDecryptor(context);
+
+    std::vector<Query> queries;
+    for (int c = 0; c < 2; ++c) {
+        std::vector<float> msg(DEGREE, 0);
+        randomFaces(msg.data(), -1, 1, 1, DEGREE);
+        queries.push_back(enc->encrypt(msg, evi::EncodeType::ITEM));
+    }
+    SearchResult result = makeSearchResult(queries);
+
+    Message expected = dec->decrypt(result, sec_key, true);
+    ASSERT_EQ(dec->getDecryptSize(result), expected.size());
+
+    std::vector<float> out(expected.size() + 3, -1.0f);
+    EXPECT_EQ(dec->decryptTo(result, sec_key, true, evi::span<float>(out)), expected.size());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), out.begin()));
+    EXPECT_EQ(out.back(), -1.0f);
+
+    std::vector<float> small(expected.size() - 1);
+    EXPECT_THROW(dec->decryptTo(result, sec_key, true, evi::span<float>(small)), evi::InvalidInputError);
+}
+
+TEST_F(EnDecryptTest, SearchResultBatchDecryptTest) {
+    Context context = makeContext(preset, device_type, rank, evi::EvalMode::FLAT);
+    KeyPack pack = makeKeyPack(context);
+    KeyGenerator keygen = makeKeyGenerator(context, pack);
+
+    auto sec_key = keygen->genSecKey();
+    keygen->genPubKeys(sec_key);
+
+    Encryptor enc = makeEncryptor(context, pack);
+    Decryptor dec = makeDecryptor(context);
+
+    std::vector<SearchResult> results;
+    for (int r = 1; r <= 3; ++r) {
+        std::vector<Query> queries;
+        for (int c = 0; c < r; ++c) {
+            std::vector<float> msg(DEGREE, 0);
+            randomFaces(msg.data(), -1, 1, 1, DEGREE);
+            queries.push_back(enc->encrypt(msg, evi::EncodeType::ITEM));
+        }
+        results.push_back(makeSearchResult(queries));
+    }
+
+    std::vector<const SearchResult *> views;
+    for (const auto &result : results) {
+        views.push_back(&result);
+    }
+    std::vector<Message> batch = dec->decryptBatch(views, sec_key, true);
+    ASSERT_EQ(batch.size(), results.size());
+    for (u64 r = 0; r < results.size(); ++r) {
+        EXPECT_EQ(batch[r], dec->decrypt(results[r], sec_key, true));
+    }
+}
+
+TEST_F(EnDecryptTest, SearchResultStreamDecryptTest) {
+    Context context = makeContext(preset, device_type, rank, evi::EvalMode::FLAT);
+    KeyPack pack = makeKeyPack(context);
+    KeyGenerator keygen = makeKeyGenerator(context, pack);
+
+    auto sec_key = keygen->genSecKey();
+    keygen->genPubKeys(sec_key);
+
+    Encryptor enc = makeEncryptor(context, pack);
+    Decryptor dec = makeDecryptor(context);
+
+    std::vector<Query> queries;
+    for (int c = 0; c < 5; ++c) {
+        std::vector<float> msg(DEGREE, 0);
+        randomFaces(msg.data(), -1, 1, 1, DEGREE);
+        queries.push_back(enc->encrypt(msg, evi::EncodeType::ITEM));
+    }
+    SearchResult result = makeSearchResult(queries);
+    result.total_item_count = 5 * DEGREE - 100;
+    Message expected = dec->decrypt(result, sec_key, true);
+
+    std::stringstream ss;
+    utils::serializeResultChunkedTo(result, ss, 2);
+
+    std::vector<float> streamed;
+    std::vector<u64> offsets;
+    dec->decryptStream(ss, sec_key, true, [&](u64 offset, evi::span<float> values) {
+        offsets.push_back(offset);
+        streamed.insert(streamed.end(), values.begin(), values.end());
+    });
+    EXPECT_EQ(offsets, (std::vector<u64>{0, 2 * DEGREE, 4 * DEGREE}));
+    ASSERT_EQ(streamed.size(), result.total_item_count);
+    EXPECT_TRUE(std::equal(streamed.begin(), streamed.end(), expected.begin()));
+
+    ss.clear();
+    ss.seekg(0);
+    SearchResult restored = utils::deserializeResultFrom(ss);
+    EXPECT_EQ(restored.getTotalItemCount(), result.total_item_count);
+    Message restored_msg = dec->decrypt(restored, sec_key, true);
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), restored_msg.begin()));
+
+    // The planar layout written by serializeResultTo streams too, whether or not the stream can seek.
+    result->ip_data->n = 5 * DEGREE;
+    result->ip_data->dim = rank;
+    result->ip_data->degree = DEGREE;
+    std::stringstream planar;
+    utils::serializeResultTo(result, planar);
+    NoSeekStreamBuf no_seek_buf(planar.str());
+    std::istream no_seek(&no_seek_buf);
+    for (std::istream *in : {static_cast<std::istream *>(&planar), &no_seek}) {
+        streamed.clear();
+        offsets.clear();
+        dec->decryptStream(*in, sec_key, true, [&](u64 offset, evi::span<float> values) {
+            offsets.push_back(offset);
+            streamed.insert(streamed.end(), values.begin(), values.end());
+        });
+        EXPECT_EQ(offsets.front(), 0u);
+        ASSERT_EQ(streamed.size(), result.total_item_count);
+        EXPECT_TRUE(std::equal(streamed.begin(), streamed.end(), expected.begin()));
+    }
+}
+
+TEST_F(EnDecryptTest, SearchResultTopKTest) {
+    Context context = makeContext(preset, device_type, rank, evi::EvalMode::FLAT);
+    KeyPack pack = makeKeyPack(context);
+    KeyGenerator keygen = makeKeyGenerator(context, pack);
+
+    auto sec_key = keygen->genSecKey();
+    keygen->genPubKeys(sec_key);
+
+    Encryptor enc = makeEncryptor(context, pack);
+    Decryptor dec = makeDecryptor(context);
+
+    std::vector<Query> queries;
+    for (int c = 0; c < 3; ++c) {
+        std::vector<float> msg(DEGREE, 0);
+        randomFaces(msg.data(), -1, 1, 1, DEGREE);
+        queries.push_back(enc->encrypt(msg, evi::EncodeType::ITEM));
+    }
+    SearchResult result = makeSearchResult(queries);
+
+    Message scores = dec->decrypt(result, sec_key, true);
+    std::vector<u64> order(scores.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](u64 lhs, u64 rhs) { return scores[lhs] > scores[rhs]; });
+
+    const u64 k = 25;
+    auto top = dec->decryptTopK(result, sec_key, k);
+    ASSERT_EQ(top.size(), k);
+    for (u64 i = 0; i < k; ++i) {
+        EXPECT_EQ(top[i].first, order[i]);
+        EXPECT_EQ(top[i].second, scores[order[i]]);
+    }
+
+    // no threshold applies: a k covering every item returns every item
+    EXPECT_EQ(dec->decryptTopK(result, sec_key, scores.size()).size(), scores.size());
+
+    // only the first total_item_count items are candidates
+    result.total_item_count = 100;
+    top = dec->decryptTopK(result, sec_key, k);
+    ASSERT_EQ(top.size(), k);
+    for (const auto &entry : top) {
+        EXPECT_LT(entry.first, 100u);
+    }
+}
+
+TEST_F(EnDecryptTest, SearchResultThresholdTest) {
+    Context context = makeContext(preset, device_type, rank, evi::EvalMode::FLAT);
+    KeyPack pack = makeKeyPack(context);
+    KeyGenerator keygen = makeKeyGenerator(context, pack);
+
+    auto sec_key = keygen->genSecKey();
+    keygen->genPubKeys(sec_key);
+
+    Encryptor enc = makeEncryptor(context, pack);
+    Decryptor dec = makeDecryptor(context);
+
+    std::vector<Query> queries;
+    for (int c = 0; c < 3; ++c) {
+        std::vector<float> msg(DEGREE, 0);
+        randomFaces(msg.data(), -1, 1, 1, DEGREE);
+        queries.push_back(enc->encrypt(msg, evi::EncodeType::ITEM));
+    }
+    SearchResult result = makeSearchResult(queries);
+
+    Message scores = dec->decrypt(result, sec_key, true);
+    std::vector<float> sorted(scores.begin(), scores.end());
+    std::sort(sorted.begin(), sorted.end(), std::greater<float>());
+    const float threshold = sorted[40];
+    std::vector<std::pair<u64, float>> expected;
+    for (u64 i = 0; i < scores.size(); ++i) {
+        if (scores[i] > threshold) {
+            expected.emplace_back(i, scores[i]);
+        }
+    }
+    EXPECT_EQ(dec->decryptAbove(result, sec_key, threshold), expected);
+
+    auto top = dec->decryptTopK(result, sec_key, 5);
+    std::vector<std::pair<u64, float>> bounded;
+    std::copy_if(top.begin(), top.end(), std::back_inserter(bounded),
+                 [&](const std::pair<u64, float> &entry) { return entry.second > threshold; });
+    EXPECT_EQ(dec->decryptAboveTopK(result, sec_key, threshold, 5), bounded);
+    EXPECT_TRUE(dec->decryptAboveTopK(result, sec_key, threshold, 0).empty());
+}
+
+TEST_F(EnDecryptTest, ShardedSearchResultTest) {
+    Context context = makeContext(preset, device_type, rank, evi::EvalMode::FLAT);
+    KeyPack pack = makeKeyPack(context);
+    KeyGenerator keygen = makeKeyGenerator(context, pack);
+
+    auto sec_key = keygen->genSecKey();
+    keygen->genPubKeys(sec_key);
+
+    Encryptor enc = makeEncryptor(context, pack);
+    Decryptor dec = makeDecryptor(context);
+
+    ShardedSearchResult sharded;
+    for (int s = 0; s < 2; ++s) {
+        std::vector<Query> queries;
+        for (int c = 0; c < 2; ++c) {
+            std::vector<float> msg(DEGREE, 0);
+            randomFaces(msg.data(), -1, 1, 1, DEGREE);
+            queries.push_back(enc->encrypt(msg, evi::EncodeType::ITEM));
+        }
+        sharded.shards.push_back(makeSearchResult(queries));
+    }
+    // the first shard ends inside its last ciphertext and the second starts right after it
+    sharded.shards[0].total_item_count = DEGREE + 100;
+    sharded.item_offsets = {0, DEGREE + 100};
+
+    Message scores = dec->decryptSharded(sharded, sec_key);
+    ASSERT_EQ(scores.size(), 3 * DEGREE + 100);
+    Message first = dec->decrypt(sharded.shards[0], sec_key, true);
+    Message second = dec->decrypt(sharded.shards[1], sec_key, true);
+    EXPECT_TRUE(std::equal(first.begin(), first.begin() + DEGREE + 100, scores.begin()));
+    EXPECT_TRUE(std::equal(second.begin(), second.end(), scores.begin() + DEGREE + 100));
+
+    std::vector<u64> order(scores.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](u64 lhs, u64 rhs) { return scores[lhs] > scores[rhs]; });
+    auto top = dec->decryptShardedTopK(sharded, sec_key, 20);
+    ASSERT_EQ(top.size(), 20u);
+    for (u64 i = 0; i < top.size(); ++i) {
+        EXPECT_EQ(top[i].first, order[i]);
+    }
+
+    std::stringstream ss;
+    utils::serializeShardedResultTo(sharded, ss);
+    ShardedSearchResult restored = utils::deserializeShardedResultFrom(ss);
+    EXPECT_EQ(restored.item_offsets, sharded.item_offsets);
+    EXPECT_EQ(dec->decryptSharded(restored, sec_key), scores);
+
+    // shards may be given in any order
+    ShardedSearchResult reversed;
+    reversed.shards = {sharded.shards[1], sharded.shards[0]};
+    reversed.item_offsets = {DEGREE + 100, 0};
+    EXPECT_EQ(dec->decryptSharded(reversed, sec_key), scores);
+
+    // a missing offset, overlapping item ranges or a gap are rejected before anything is decrypted
+    ShardedSearchResult missing = sharded;
+    missing.item_offsets.pop_back();
+    EXPECT_THROW(dec->decryptSharded(missing, sec_key), evi::InvalidInputError);
+    EXPECT_THROW(dec->decryptShardedTopK(missing, sec_key, 10), evi::InvalidInputError);
+
+    ShardedSearchResult overlapping = sharded;
+    overlapping.item_offsets = {3 * DEGREE, DEGREE + 99};
+    EXPECT_THROW(dec->decryptSharded(overlapping, sec_key), evi::InvalidInputError);
+    EXPECT_THROW(dec->decryptShardedTopK(overlapping, sec_key, 10), evi::InvalidInputError);
+
+    ShardedSearchResult gapped = sharded;
+    gapped.item_offsets = {0, 3 * DEGREE};
+    EXPECT_THROW(dec->decryptSharded(gapped, sec_key), evi::InvalidInputError);
+    EXPECT_THROW(dec->decryptShardedTopK(gapped, sec_key, 10), evi::InvalidInputError);
+    gapped.item_offsets = {1, DEGREE + 101};
+    EXPECT_THROW(utils::validateShardedResult(gapped), evi::InvalidInputError);
+    // a huge offset from the wire must not size the output
+    gapped.item_offsets = {0, u64(1) << 40};
+    std::stringstream gap_ss;
+    utils::serializeShardedResultTo(gapped, gap_ss);
+    EXPECT_THROW(utils::deserializeShardedResultFrom(gap_ss), evi::InvalidInputError);
+
+    overlapping.item_offsets = {0, DEGREE + 99};
+    std::stringstream overlap_ss;
+    utils::serializeShardedResultTo(overlapping, overlap_ss);
+    EXPECT_THROW(utils::deserializeShardedResultFrom(overlap_ss), evi::InvalidInputError);
+}
+
+TEST_F(EnDecryptTest, LevelZeroQuerySerializeTest) {
+    Context context = makeContext(preset, device_type, rank, evi::EvalMode::FLAT);
+    KeyPack pack = makeKeyPack(context);
+    KeyGenerator keygen = makeKeyGenerator(context, pack);
+
+    auto sec_key = keygen->genSecKey();
+    keygen->genPubKeys(sec_key);
+
+    Encryptor enc = makeEncryptor(context, pack);
+    Decryptor dec = makeDecryptor(context);
+
+    std::vector<float> msg(DEGREE, 0);
+    randomFaces(msg.data(), -1, 1, 1, rank);
+
+    auto query = enc->encrypt(msg, evi::EncodeType::ITEM);
+    ASSERT_EQ(query[0]->getLevel(), 0);
+    EXPECT_THROW(query[0]->getPoly(0, 1), evi::InvalidAccessError);
+
+    std::stringstream ss(std::ios::binary | std::ios::in | std::ios::out);
+    utils::serializeQueryTo(query, ss);
+    auto restored = utils::deserializeQueryFrom(ss);
+    ASSERT_EQ(restored.size(), query.size());
+    EXPECT_EQ(restored[0]->getLevel(), 0);
+    EXPECT_EQ(std::memcmp(restored[0]->getPolyData(1, 0), query[0]->getPolyData(1, 0), U64_DEGREE), 0);
+    EXPECT_EQ(std::memcmp(restored[0]->getPolyData(0, 0), query[0]->getPolyData(0, 0), U64_DEGREE), 0);
+    EXPECT_THROW(restored[0]->getPoly(1, 1), evi::InvalidAccessError);
+
+    auto dmsg = dec->decrypt(restored, sec_key);
+    EXPECT_LE(maxError(dmsg, msg), MAX_ERROR);
+}
+
+TEST_F(EnDecryptTest, BufferSerializeTest) {
+    Context context = makeContext(preset, device_type, rank, evi::EvalMode::FLAT);
+    KeyPack pack = makeKeyPack(context);
+    KeyGenerator keygen = makeKeyGenerator(context, pack);
+
+    auto sec_key = keygen->genSecKey();
+    keygen->genPubKeys(sec_key);
+
+    Encryptor enc = makeEncryptor(context, pack);
+    Decryptor dec = makeDecryptor(context);
+
+    std::vector<float> msg(DEGREE, 0);
+    randomFaces(msg.data(), -1, 1, 1, rank);
+    auto query = enc->encrypt(msg, evi::EncodeType::ITEM);
+
+    std::stringstream ss;
+    query[0]->serializeTo(ss);
+    const std::string expected = ss.str();
+
+    // the buffer writer appends exactly the stream bytes
+    std::vector<u8> buf = {7};
+    query[0]->serializeTo(buf);
+    ASSERT_EQ(buf.size(), expected.size() + 1);
+    EXPECT_EQ(buf[0], 7);
+    EXPECT_EQ(std::memcmp(buf.data() + 1, expected.data(), expected.size()), 0);
+
+    buf.erase(buf.begin());
+    query[0]->getPolyData(0, 0)[0] ^= 1;
+    query[0]->deserializeFrom(buf);
+    std::stringstream again;
+    query[0]->serializeTo(again);
+    EXPECT_EQ(again.str(), expected);
+
+    auto write = [&](std::ostream &os) { query[0]->serializeTo(os); };
+    EXPECT_EQ(query[0]->getSerializedSize(), expected.size());
+    std::vector<char> small(expected.size() - 1);
+    EXPECT_THROW(utils::serializeToBuffer(small.data(), small.size(), write), evi::InvalidInputError);
+
+    // the computed sizes match what the query and result writers produce
+    std::stringstream query_ss;
+    utils::serializeQueryTo(query, query_ss);
+    EXPECT_EQ(utils::getQuerySerializedSize(query), query_ss.str().size());
+    SearchResult result = makeSearchResult({query, query});
+    result->ip_data->n = 2 * DEGREE;
+    result->ip_data->dim = rank;
+    result->ip_data->degree = DEGREE;
+    std::stringstream result_ss;
+    utils::serializeResultTo(result, result_ss);
+    const std::string result_bytes = result_ss.str();
+    EXPECT_EQ(utils::getResultSerializedSize(result), result_bytes.size());
+
+    // a Matrix without a degree yet serializes as its header alone
+    Matrix<evi::DataType::CIPHER> empty(0);
+    std::stringstream empty_ss;
+    empty.serializeTo(empty_ss);
+    EXPECT_EQ(empty.getSerializedSize(), empty_ss.str().size());
+
+    // a truncated buffer is rejected instead of yielding a half-filled result
+    auto read_result = [&](std::istream &is) { utils::deserializeResultFrom(is); };
+    EXPECT_NO_THROW(utils::deserializeFromBuffer(result_bytes.data(), result_bytes.size(), read_result));
+    EXPECT_THROW(utils::deserializeFromBuffer(result_bytes.data(), result_bytes.size() - 1, read_result),
+                 evi::InvalidInputError);
+
+    // a degree other than DEGREE is rejected whether the result is read whole or streamed
+    std::string bad_degree = result_bytes;
+    const u64 half_degree = DEGREE / 2;
+    std::memcpy(&bad_degree[sizeof(uint8_t) + sizeof(u32) + sizeof(int) + 2 * sizeof(u64)], &half_degree,
+                sizeof(half_degree));
+    EXPECT_THROW(utils::deserializeFromBuffer(bad_degree.data(), bad_degree.size(), read_result),
+                 evi::InvalidInputError);
+    std::stringstream bad_degree_ss(bad_degree);
+    bad_degree_ss.seekg(sizeof(uint8_t) + sizeof(u32));
+    EXPECT_THROW(utils::readResultPlanarHeader(bad_degree_ss), evi::InvalidInputError);
+
+    // the in-place reader seeks like a stringstream
+    utils::SpanStreamBuf span_buf(result_bytes.data(), result_bytes.size());
+    std::istream span_is(&span_buf);
+    span_is.seekg(0, std::ios::end);
+    EXPECT_EQ(static_cast<size_t>(span_is.tellg()), result_bytes.size());
+    span_is.seekg(1);
+    EXPECT_EQ(span_is.tellg(), std::streampos(1));
+    span_is.seekg(-1, std::ios::cur);
+    EXPECT_EQ(span_is.get(), static_cast<unsigned char>(result_bytes[0]));
+}
+
+TEST_F(EnDecryptTest, QuantizedInputEncDecTest) {
+    Context context = makeContext(preset, device_type, rank, evi::EvalMode::FLAT);
+    KeyPack pack = makeKeyPack(context);
+    KeyGenerator keygen = makeKeyGenerator(context, pack);
+
+    auto sec_key = keygen->genSecKey();
+    keygen->genPubKeys(sec_key);
+
+    Encryptor enc = makeEncryptor(context, pack);
+    Decryptor dec = makeDecryptor(context);
+
+    std::vector<float> msg(rank, 0);
+    randomFaces(msg.data(), -1, 1, 1, rank);
+
+    // bf16 keeps the upper half of each float; compare against the truncated values
+    std::vector<u16> bf16(rank);
+    std::vector<float> bf16_ref(rank);
+    for (u32 i = 0; i < rank; ++i) {
+        u32 bits;
+        std::memcpy(&bits, &msg[i], sizeof(float));
+        bf16[i] = static_cast<u16>(bits >> 16);
+        bits &= 0xffff0000U;
+        std::memcpy(&bf16_ref[i], &bits, sizeof(float));
+    }
+    auto query = enc->encrypt(evi::span<u16>(bf16), evi::HalfFormat::BF16, pack, evi::EncodeType::ITEM);
+    EXPECT_LE(maxError(bf16_ref, dec->decrypt(query, sec_key)), MAX_ERROR);
+
+    const float quant_scale = 1.0f / 127;
+    std::vector<i8> int8(rank);
+    std::vector<float> int8_ref(rank);
+    for (u32 i = 0; i < rank; ++i) {
+        int8[i] = static_cast<i8>(std::lround(msg[i] * 127));
+        int8_ref[i] = int8[i] * quant_scale;
+    }
+    query = enc->encrypt(evi::span<i8>(int8), quant_scale, pack, evi::EncodeType::ITEM);
+    EXPECT_LE(maxError(int8_ref, dec->decrypt(query, sec_key)), MAX_ERROR);
+
+    // fp16 1.0, -2.0, 0.5 and the smallest subnormal
+    std::vector<u16> fp16 = {0x3c00, 0xc000, 0x3800, 0x0001};
+    std::vector<float> fp16_ref = {1.0f, -2.0f, 0.5f, 0x1p-24f};
+    query = enc->encrypt(evi::span<u16>(fp16), evi::HalfFormat::FP16, pack, evi::EncodeType::ITEM);
+    EXPECT_LE(maxError(fp16_ref, dec->decrypt(query, sec_key)), MAX_ERROR);
+
+    // quantized values are converted straight into the encode buffer and must encode exactly like their fp32 values
+    auto half_plain = enc->encode(evi::span<u16>(bf16), evi::HalfFormat::BF16, evi::EncodeType::QUERY);
+    auto float_plain = enc->encode(evi::span<float>(bf16_ref), evi::EncodeType::QUERY);
+    ASSERT_EQ(half_plain.size(), float_plain.size());
+    EXPECT_EQ(half_plain[0]->getPoly(0, 0), float_plain[0]->getPoly(0, 0));
+}
+
+TEST_F(EnDecryptTest, NormalizedEncDecTest) {
+    Context context = makeContext(preset, device_type, rank, evi::EvalMode::FLAT);
+    KeyPack pack = makeKeyPack(context);
+    KeyGenerator keygen = makeKeyGenerator(context, pack);
+
+    auto sec_key = keygen->genSecKey();
+    keygen->genPubKeys(sec_key);
+
+    Encryptor enc = makeEncryptor(context, pack);
+    Decryptor dec = makeDecryptor(context);
+
+    std::vector<std::vector<float>> msgs(3, std::vector<float>(rank, 0));
+    std::vector<std::vector<float>> units(msgs.size());
+    std::vector<float> ref_norms;
+    for (auto &msg : msgs) {
+        randomFaces(msg.data(), -4, 4, 1, rank);
+        double sum = 0.0;
+        for (float v : msg) {
+            sum += static_cast<double>(v) * v;
+        }
+        ref_norms.push_back(static_cast<float>(std::sqrt(sum)));
+        units[ref_norms.size() - 1].resize(rank);
+        for (u32 i = 0; i < rank; ++i) {
+            units[ref_norms.size() - 1][i] = msg[i] / ref_norms.back();
+        }
+    }
+
+    float norm = 0;
+    auto query = enc->encryptNormalized(evi::span<float>(msgs[0]), pack, evi::EncodeType::ITEM, false, std::nullopt,
+                                        &norm);
+    EXPECT_NEAR(norm, ref_norms[0], 1e-3f * ref_norms[0]);
+    EXPECT_LE(maxError(units[0], dec->decrypt(query, sec_key)), MAX_ERROR);
+
+    std::vector<float> norms;
+    auto queries = enc->encryptNormalized(msgs, pack, evi::EncodeType::ITEM, false, std::nullopt, &norms);
+    ASSERT_EQ(queries.size(), msgs.size());
+    ASSERT_EQ(norms.size(), msgs.size());
+    for (u64 i = 0; i < msgs.size(); ++i) {
+        EXPECT_NEAR(norms[i], ref_norms[i], 1e-3f * ref_norms[i]);
+        EXPECT_LE(maxError(units[i], dec->decrypt(queries[i], sec_key)), MAX_ERROR);
+    }
+
+    // Packed items share a ciphertext, so each one is scaled by its own gain while being placed.
+    enc->setFlatItemPacking(true);
+    std::vector<float> packed_norms;
+    auto packed = enc->encryptNormalized(msgs, pack, evi::EncodeType::ITEM, false, std::nullopt, &packed_norms);
+    ASSERT_EQ(packed_norms.size(), msgs.size());
+    for (u64 i = 0; i < msgs.size(); ++i) {
+        EXPECT_NEAR(packed_norms[i], ref_norms[i], 1e-3f * ref_norms[i]);
+    }
+    u64 idx = 0;
+    for (const auto &query : packed) {
+        auto dmsg = dec->decrypt(query, sec_key);
+        ASSERT_EQ(dmsg.size(), query.getInnerItemCount() * rank);
+        for (u64 k = 0; k < query.getInnerItemCount(); ++k, ++idx) {
+            EXPECT_LE(maxError(evi::span<float>(dmsg.data() + k * rank, rank), units[idx]), MAX_ERROR);
+        }
+    }
+    EXPECT_EQ(idx, msgs.size());
+
+    // the norm of an encoded vector is taken while it is placed into the encode buffer
+    norm = 0;
+    enc->encodeNormalized(evi::span<float>(msgs[1]), evi::EncodeType::QUERY, false, std::nullopt, &norm);
+    EXPECT_NEAR(norm, ref_norms[1], 1e-3f * ref_norms[1]);
+}
+
+TEST_F(EnDecryptTest, RMSCompactQuerySerializeTest) {
+    Context context = makeContext(preset, device_type, rank, evi::EvalMode::RMS);
+    Encryptor enc = makeEncryptor(context);
+
+    std::vector<float> msg(rank, 0);
+    randomFaces(msg.data(), -1, 1, 1, rank);
+
+    auto query = enc->encode(msg, evi::EncodeType::QUERY);
+    ASSERT_FALSE(query.empty());
+    auto block = std::dynamic_pointer_cast<SerializedSingleQuery<evi::DataType::PLAIN>>(query[0]);
+    ASSERT_NE(block, nullptr);
+    EXPECT_EQ(block->getDataType(), evi::DataType::SERIALIZED_PLAIN);
+    EXPECT_EQ(block->getSerializedSize(),
+              sizeof(int) + 5 * sizeof(u64) + sizeof(std::underlying_type_t<evi::EncodeType>) + U64_DEGREE);
+
+    // the widened view matches the 64-bit plane, and a copy builds its own
+    u128 *wide = block->getPolyData();
+    SerializedSingleQuery<evi::DataType::PLAIN> copy(*block);
+    u128 *copy_wide = copy.getPolyData();
+    EXPECT_NE(copy_wide, wide);
+    for (u64 i = 0; i < DEGREE; ++i) {
+        ASSERT_EQ(wide[i], static_cast<u128>(block->getPolyData(0, 0)[i]));
+        ASSERT_EQ(copy_wide[i], wide[i]);
+    }
+
+    std::stringstream ss(std::ios::binary | std::ios::in | std::ios::out);
+    utils::serializeQueryTo(query, ss);
+    EXPECT_LT(ss.str().size(), query.size() * (U64_DEGREE + 64));
+    auto restored = utils::deserializeQueryFrom(ss);
+    ASSERT_EQ(restored.size(), query.size());
+    for (u64 i = 0; i < query.size(); ++i) {
+        EXPECT_EQ(restored[i]->getDataType(), evi::DataType::SERIALIZED_PLAIN);
+        EXPECT_EQ(restored[i]->show_dim, query[i]->show_dim);
+        EXPECT_EQ(std::memcmp(restored[i]->getPolyData(0, 0), query[i]->getPolyData(0, 0), U64_DEGREE), 0);
+    }
+}
+
+TEST_F(EnDecryptTest, RMSEncodeRoundTripTest) {
+    Context context = makeContext(preset, device_type, rank, evi::EvalMode::RMS);
+    Encryptor enc = makeEncryptor(context);
+
+    std::vector<float> msg(rank, 0);
+    randomFaces(msg.data(), -1, 1, 1, rank);
+
+    const u64 scale_bits = static_cast<u64>(context->getParam()->getScaleFactor());
+    const double delta = std::pow(2.0, scale_bits);
+    const u64 prime_q = context->getParam()->getPrimeQ();
+
+    auto query = enc->encode(msg, evi::EncodeType::ITEM);
+    std::stringstream ss(std::ios::binary | std::ios::in | std::ios::out);
+    utils::serializeQueryTo(query, ss);
+    auto restored = utils::deserializeQueryFrom(ss);
+    ASSERT_EQ(restored.size(), query.size());
+
+    // Rebuild each block's plaintext by hand: rounded, reduced mod Q and moved to the NTT domain.
+    for (u64 j = 0, offset = 0; j < query.size(); ++j) {
+        auto block = std::dynamic_pointer_cast<SerializedSingleQuery<evi::DataType::PLAIN>>(restored[j]);
+        ASSERT_NE(block, nullptr);
+        EXPECT_EQ(block->scale_bit, scale_bits);
+
+        const u64 block_dim = block->dim;
+        poly expected{};
+        for (u64 i = 0; i < block_dim && offset + i < msg.size(); ++i) {
+            const double v = msg[offset + i] * delta;
+            const i64 rounded = static_cast<i64>(v + (v > 0 ? 0.5 : -0.5));
+            expected[i] = rounded >= 0 ? static_cast<u64>(rounded) % prime_q
+                                       : (prime_q - static_cast<u64>(-rounded) % prime_q) % prime_q;
+        }
+        context->nttModQMini(expected, block_dim);
+        offset += block_dim;
+
+        const poly &lo = std::as_const(*block).getPoly(0, 0);
+        EXPECT_TRUE(std::equal(lo.begin(), lo.end(), expected.begin()));
+        EXPECT_EQ(std::memcmp(lo.data(), query[j]->getPolyData(0, 0), U64_DEGREE), 0);
+    }
+}
+
+TEST_F(EnDecryptTest, FLATPackedBatchEncDecTest) {
+    Context context = makeContext(preset, device_type, rank, evi::EvalMode::FLAT);
+    KeyPack pack = makeKeyPack(context);
+    KeyGenerator keygen = makeKeyGenerator(context, pack);
+
+    auto sec_key = keygen->genSecKey();
+    keygen->genPubKeys(sec_key);
+
+    Encryptor enc = makeEncryptor(context, pack);
+    Decryptor dec = makeDecryptor(context);
+    enc->setFlatItemPacking(true);
+
+    const u64 stride = isPowerOfTwo(rank) ? rank : nextPowerOfTwo(rank);
+    const u64 items_per_ctxt = DEGREE / stride;
+    std::vector<std::vector<float>> msgs(items_per_ctxt + 3, std::vector<float>(rank, 0));
+    for (auto &msg : msgs) {
+        randomFaces(msg.data(), -1, 1, 1, rank);
+    }
+    const u64 num_ctxt = (msgs.size() + items_per_ctxt - 1) / items_per_ctxt;
+    const u64 last_count = msgs.size() - (num_ctxt - 1) * items_per_ctxt;
+
+    for (auto type : {evi::EncodeType::ITEM, evi::EncodeType::QUERY}) {
+        auto queries = enc->encrypt(msgs, pack, type);
+        ASSERT_EQ(queries.size(), num_ctxt);
+        EXPECT_EQ(queries[0].getInnerItemCount(), items_per_ctxt);
+        EXPECT_EQ(queries.back().getInnerItemCount(), last_count);
+
+        // The packed layout travels with the serialized query.
+        std::stringstream ss;
+        utils::serializeQueryTo(queries.back(), ss);
+        auto restored = utils::deserializeQueryFrom(ss);
+        ASSERT_EQ(restored.getInnerItemCount(), last_count);
+        queries.push_back(restored);
+
+        for (u64 q = 0; q < queries.size(); ++q) {
+            const u64 first = std::min<u64>(q, num_ctxt - 1) * items_per_ctxt;
+            const u64 count = queries[q].getInnerItemCount();
+            auto dmsg = dec->decrypt(queries[q], sec_key);
+            ASSERT_EQ(dmsg.size(), count * rank);
+            for (u64 k = 0; k < count; ++k) {
+                EXPECT_LE(maxError(evi::span<float>(dmsg.data() + k * rank, rank), msgs[first + k]), MAX_ERROR);
+            }
+        }
+    }
+}
+
+TEST_F(EnDecryptTest, RMPItemPackerTest) {
+    const u32 dim = 128;
+    Context context = makeContext(preset, device_type, dim, evi::EvalMode::RMP);
+    KeyPack pack = makeKeyPack(context);
+    KeyGenerator keygen = makeKeyGenerator(context, pack);
+
+    auto sec_key = keygen->genSecKey();
+    keygen->genPubKeys(sec_key);
+
+    Encryptor enc = makeEncryptor(context, pack);
+    Decryptor dec = makeDecryptor(context);
+    ItemPacker packer(enc, pack);
+
+    std::vector<std::vector<float>> msgs;
+    std::vector<Query> queries;
+    u32 items_per_ctxt = 0;
+    while (!queries.size()) {
+        std::vector<std::vector<float>> batch(7, std::vector<float>(dim, 0));
+        for (auto &msg : batch) {
+            randomFaces(msg.data(), -1, 1, 1, dim);
+        }
+        msgs.insert(msgs.end(), batch.begin(), batch.end());
+        queries = packer.add(batch);
+        items_per_ctxt = packer.getItemsPerCiphertext();
+    }
+    ASSERT_EQ(queries.size(), 1u);
+    EXPECT_EQ(queries[0][0]->n, items_per_ctxt);
+    EXPECT_EQ(packer.getPendingCount(), msgs.size() - items_per_ctxt);
+
+    auto rest = packer.flush();
+    EXPECT_EQ(packer.getPendingCount(), 0u);
+    EXPECT_TRUE(packer.flush().empty());
+    queries.insert(queries.end(), rest.begin(), rest.end());
+
+    u64 idx = 0;
+    for (auto &query : queries) {
+        for (int i = 0; i < query[0]->n; ++i) {
+            auto dmsg = dec->decrypt(i, query, sec_key);
+            EXPECT_LE(maxError(msgs[idx++], dmsg), MAX_ERROR);
+        }
+    }
+    EXPECT_EQ(idx, msgs.size());
+}
+
+TEST_F(EnDecryptTest, EncodeQueryCacheTest) {
+    Context context = makeContext(preset, device_type, rank, evi::EvalMode::RMP);
+    Encryptor enc = makeEncryptor(context);
+    enc->setQueryCacheCapacity(2);
+
+    std::vector<std::vector<float>> msgs(3, std::vector<float>(rank, 0));
+    for (auto &msg : msgs) {
+        randomFaces(msg.data(), -1, 1, 1, rank);
+    }
+
+    auto first = enc->encode(msgs[0], evi::EncodeType::QUERY);
+    auto second = enc->encode(msgs[0], evi::EncodeType::QUERY);
+    ASSERT_EQ(first.size(), second.size());
+    EXPECT_NE(first[0].get(), second[0].get());
+    EXPECT_EQ(first[0]->getPoly(0, 0), second[0]->getPoly(0, 0));
+
+    // a hit is the caller's own copy: changing it must not leak into the cache or into later hits
+    const poly expected = first[0]->getPoly(0, 0);
+    first[0]->getPoly(0, 0).fill(0);
+    second[0]->getPoly(0, 0).fill(0);
+    auto third = enc->encode(msgs[0], evi::EncodeType::QUERY);
+    EXPECT_EQ(third[0]->getPoly(0, 0), expected);
+
+    // different encode parameters must not hit
+    auto item = enc->encode(msgs[0], evi::EncodeType::ITEM);
+    EXPECT_NE(item[0].get(), first[0].get());
+
+    enc->encode(msgs[1], evi::EncodeType::QUERY);
+    enc->encode(msgs[2], evi::EncodeType::QUERY);
+
+    auto stats = enc->getQueryCacheStats();
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.misses, 4u);
+    EXPECT_EQ(stats.evictions, 2u);
+    EXPECT_EQ(stats.size, 2u);
+
+    enc->setQueryCacheCapacity(0);
+    EXPECT_EQ(enc->getQueryCacheStats().capacity, 0u);
+    EXPECT_EQ(enc->getQueryCacheStats().size, 0u);
+    EXPECT_EQ(enc->encode(msgs[0], evi::EncodeType::QUERY)[0]->getPoly(0, 0), expected);
+    EXPECT_EQ(enc->getQueryCacheStats().misses, 0u);
+}
+
 TEST_F(EnDecryptTest, MultiKeyGenSeDeserializeEnDecTest) {
     Context context = makeContext(preset, device_type, rank, evi::EvalMode::RMP);
     SealInfo s_info(evi::SealMode::NONE);